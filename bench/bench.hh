@@ -0,0 +1,352 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_BENCH_BENCH_HH
+#define PEGTL_BENCH_BENCH_HH
+
+#include <map>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include <pegtl.hh>
+#include <pegtl/read_parser.hh>
+#include <pegtl/mmap_parser.hh>
+
+namespace pegtl
+{
+   namespace bench
+   {
+      // Command line options common to all benchmarks:
+      //   --size=BYTES        approximate size of the generated corpora
+      //   --repeat=N          number of runs, the fastest run is reported
+      //   --filter=TEXT       only run benchmarks whose name contains TEXT
+      //   --input=NAME        only use the given input (memory, mmap, read, cstream, istream)
+      //   --file=PATH         temporary file for the file-based inputs
+      //   --baseline=PATH     baseline to compare against, or to update, by default none
+      //   --tolerance=PERCENT slowdown against the baseline that is not a regression
+      //   --update-baseline   write the results to the baseline instead of comparing
+
+      struct options
+      {
+         std::size_t size = 1 << 22;
+         unsigned repeat = 5;
+         std::string filter;
+         std::string input;
+         std::string file;
+         std::string baseline;
+         double tolerance = 20.0;
+         bool update = false;
+
+         bool selected( const std::string & name ) const
+         {
+            return name.find( filter ) != std::string::npos;
+         }
+
+         bool selected_input( const char * name ) const
+         {
+            return input.empty() || ( input == name );
+         }
+      };
+
+      inline bool option( const char * arg, const char * name, std::string & value )
+      {
+         const std::size_t n = std::strlen( name );
+         if ( ( std::strncmp( arg, name, n ) == 0 ) && ( arg[ n ] == '=' ) ) {
+            value = arg + n + 1;
+            return true;
+         }
+         return false;
+      }
+
+      inline void usage( const char * program )
+      {
+         std::cerr << "usage: " << program << " [--size=BYTES] [--repeat=N] [--filter=TEXT] [--input=NAME] [--file=PATH] [--baseline=PATH [--tolerance=PERCENT] [--update-baseline]]" << std::endl;
+         std::exit( 2 );
+      }
+
+      inline options parse_options( const int argc, char ** argv )
+      {
+         options nrv;
+         nrv.file = std::string( argv[ 0 ] ) + ".corpus";
+         for ( int i = 1; i < argc; ++i ) {
+            std::string v;
+            if ( option( argv[ i ], "--size", v ) ) {
+               nrv.size = std::strtoul( v.c_str(), nullptr, 10 );
+            }
+            else if ( option( argv[ i ], "--repeat", v ) ) {
+               nrv.repeat = unsigned( std::max( std::strtoul( v.c_str(), nullptr, 10 ), 1ul ) );
+            }
+            else if ( option( argv[ i ], "--tolerance", v ) ) {
+               nrv.tolerance = std::strtod( v.c_str(), nullptr );
+            }
+            else if ( std::strcmp( argv[ i ], "--update-baseline" ) == 0 ) {
+               nrv.update = true;
+            }
+            else if ( option( argv[ i ], "--filter", nrv.filter ) || option( argv[ i ], "--input", nrv.input ) || option( argv[ i ], "--file", nrv.file ) || option( argv[ i ], "--baseline", nrv.baseline ) ) {
+            }
+            else {
+               usage( argv[ 0 ] );
+            }
+         }
+         if ( nrv.update && nrv.baseline.empty() ) {
+            usage( argv[ 0 ] );
+         }
+         return nrv;
+      }
+
+      // Deterministic pseudo-random numbers (xorshift64*) so that the
+      // generated corpora are identical on all platforms and runs.
+
+      class random
+      {
+      public:
+         explicit
+         random( const std::uint64_t seed = 0x2545f4914f6cdd1d )
+               : m_state( seed )
+         { }
+
+         std::uint64_t operator() ()
+         {
+            m_state ^= m_state >> 12;
+            m_state ^= m_state << 25;
+            m_state ^= m_state >> 27;
+            return m_state * 0x2545f4914f6cdd1dull;
+         }
+
+         // Uniform in [ 0, n ), modulo bias is irrelevant here.
+
+         std::size_t operator() ( const std::size_t n )
+         {
+            return std::size_t( ( * this )() >> 11 ) % n;
+         }
+
+         const char * pick( const char * const * words, const std::size_t count )
+         {
+            return words[ ( * this )( count ) ];
+         }
+
+      private:
+         std::uint64_t m_state;
+      };
+
+      // A benchmark session prints every result as one line of JSON and,
+      // when a baseline was given, compares it against the baseline, a text
+      // file with one line of "benchmark input size ns_per_byte" per result,
+      // where size is the --size of the corpora. Results that are more than
+      // tolerance percent slower than in the baseline are regressions, which
+      // make finish() return non-zero, as does a baseline that can not be
+      // read; results that are not in the baseline are reported as warnings.
+
+      class session
+      {
+      public:
+         session( const int argc, char ** argv )
+               : m_options( parse_options( argc, argv ) ),
+                 m_program( argv[ 0 ] )
+         {
+            if ( ( ! m_options.update ) && ( ! m_options.baseline.empty() ) ) {
+               std::ifstream i( m_options.baseline );
+               if ( ! i ) {
+                  std::cerr << m_program << ": WARNING unable to read baseline " << m_options.baseline << ", run with --update-baseline to create it" << std::endl;
+                  m_missing = true;
+               }
+               std::string benchmark, input;
+               std::size_t size;
+               double ns_per_byte;
+               while ( i >> benchmark >> input >> size >> ns_per_byte ) {
+                  m_baseline[ key( benchmark, input, size ) ] = ns_per_byte;
+               }
+            }
+         }
+
+         session( const session & ) = delete;
+         void operator= ( const session & ) = delete;
+
+         const options & op() const
+         {
+            return m_options;
+         }
+
+         void report( const std::string & benchmark, const char * input, const std::size_t bytes, const double seconds )
+         {
+            const double ns_per_byte = bytes ? ( seconds * 1e9 / double( bytes ) ) : 0.0;
+            const double mb_per_s = seconds > 0.0 ? ( double( bytes ) / seconds / 1e6 ) : 0.0;
+            char buffer[ 128 ];
+            std::snprintf( buffer, sizeof( buffer ), "\"seconds\": %.6f, \"mb_per_s\": %.2f, \"ns_per_byte\": %.3f", seconds, mb_per_s, ns_per_byte );
+            std::cout << "{ \"benchmark\": \"" << benchmark << "\", \"input\": \"" << input << "\", \"bytes\": " << bytes << ", \"repeat\": " << m_options.repeat << ", " << buffer;
+
+            const auto i = m_baseline.find( key( benchmark, input, m_options.size ) );
+            if ( i != m_baseline.end() ) {
+               const double change = ( i->second > 0.0 ) ? ( ( ns_per_byte / i->second - 1.0 ) * 100.0 ) : 0.0;
+               std::snprintf( buffer, sizeof( buffer ), ", \"baseline_ns_per_byte\": %.3f, \"change_percent\": %.1f", i->second, change );
+               std::cout << buffer;
+               if ( change > m_options.tolerance ) {
+                  std::snprintf( buffer, sizeof( buffer ), " %.3f ns/byte instead of %.3f ns/byte (%+.1f%%)", ns_per_byte, i->second, change );
+                  m_regressions.push_back( benchmark + ' ' + input + buffer );
+               }
+            }
+            else if ( ( ! m_options.update ) && ( ! m_options.baseline.empty() ) && ( ! m_missing ) ) {
+               m_unknown.push_back( key( benchmark, input, m_options.size ) );
+            }
+            std::cout << " }" << std::endl;
+            m_results.emplace_back( key( benchmark, input, m_options.size ), ns_per_byte );
+         }
+
+         // Writes the baseline for --update-baseline, or reports the
+         // regressions; returns the exit status for main().
+
+         int finish() const
+         {
+            if ( m_options.update ) {
+               std::ofstream o( m_options.baseline, std::ios::trunc );
+               for ( const auto & r : m_results ) {
+                  o << r.first << ' ' << r.second << '\n';
+               }
+               if ( ! o.flush() ) {
+                  std::cerr << m_program << ": unable to write baseline " << m_options.baseline << std::endl;
+                  return 1;
+               }
+               return 0;
+            }
+            for ( const auto & u : m_unknown ) {
+               std::cerr << m_program << ": WARNING no baseline for " << u << std::endl;
+            }
+            for ( const auto & r : m_regressions ) {
+               std::cerr << m_program << ": REGRESSION " << r << std::endl;
+            }
+            if ( m_missing ) {
+               std::cerr << m_program << ": no baseline " << m_options.baseline << " to compare against" << std::endl;
+               return 1;
+            }
+            return m_regressions.empty() ? 0 : 1;
+         }
+
+      private:
+         const options m_options;
+         const std::string m_program;
+         std::map< std::string, double > m_baseline;
+         std::vector< std::pair< std::string, double > > m_results;
+         std::vector< std::string > m_regressions;
+         std::vector< std::string > m_unknown;
+         bool m_missing = false;
+
+         static std::string key( const std::string & benchmark, const std::string & input, const std::size_t size )
+         {
+            return benchmark + ' ' + input + ' ' + std::to_string( size );
+         }
+      };
+
+      // Returns the fastest of repeat runs of f(), which has to return true.
+
+      template< typename F >
+      double measure( const std::string & benchmark, const char * input, const unsigned repeat, const F & f )
+      {
+         double nrv = 0.0;
+         for ( unsigned i = 0; i < repeat; ++i ) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool result = f();
+            const std::chrono::duration< double > d = std::chrono::steady_clock::now() - start;
+            if ( ! result ) {
+               throw std::runtime_error( "benchmark " + benchmark + " failed to parse its corpus with " + input + " input" );
+            }
+            if ( ( i == 0 ) || ( d.count() < nrv ) ) {
+               nrv = d.count();
+            }
+         }
+         return nrv;
+      }
+
+      inline void write_file( const std::string & filename, const std::string & data )
+      {
+         std::ofstream o( filename, std::ios::binary | std::ios::trunc );
+         o.write( data.data(), std::streamsize( data.size() ) );
+         if ( ! o.flush() ) {
+            throw std::runtime_error( "unable to write corpus file " + filename );
+         }
+      }
+
+      template< typename Rule >
+      void run_memory( session & s, const std::string & benchmark, const std::string & data )
+      {
+         if ( s.op().selected_input( "memory" ) ) {
+            s.report( benchmark, "memory", data.size(), measure( benchmark, "memory", s.op().repeat, [ & ](){ return parse_memory< Rule >( data.data(), data.size(), "memory" ); } ) );
+         }
+      }
+
+      template< typename Rule >
+      void run_buffered( session &, const std::string &, const std::string &, const std::false_type & )
+      { }
+
+      // The buffer inputs keep all data in the buffer as the grammars don't discard.
+
+      template< typename Rule >
+      void run_buffered( session & s, const std::string & benchmark, const std::string & data, const std::true_type & )
+      {
+         const std::size_t size = data.size();
+         const std::string & file = s.op().file;
+
+         if ( s.op().selected_input( "cstream" ) ) {
+            s.report( benchmark, "cstream", size, measure( benchmark, "cstream", s.op().repeat, [ & ]()
+               {
+                  std::FILE * stream = std::fopen( file.c_str(), "rb" );
+                  if ( ! stream ) {
+                     throw std::runtime_error( "unable to open corpus file " + file );
+                  }
+                  try {
+                     const bool result = parse_cstream< Rule >( stream, file.c_str(), size + 64 );
+                     std::fclose( stream );
+                     return result;
+                  }
+                  catch ( ... ) {
+                     std::fclose( stream );
+                     throw;
+                  }
+               } ) );
+         }
+         if ( s.op().selected_input( "istream" ) ) {
+            s.report( benchmark, "istream", size, measure( benchmark, "istream", s.op().repeat, [ & ]()
+               {
+                  std::ifstream stream( file, std::ios::binary );
+                  return parse_istream< Rule >( stream, file, size + 64 );
+               } ) );
+         }
+      }
+
+      // Parses the corpus with Rule from every type of input; the buffer
+      // inputs are skipped for grammars with Buffered == false, e.g. those
+      // that use raw_string<> which requires a memory based input.
+
+      template< typename Rule, bool Buffered = true >
+      void run( session & s, const std::string & benchmark, const std::string & data )
+      {
+         const std::string & file = s.op().file;
+
+         run_memory< Rule >( s, benchmark, data );
+         write_file( file, data );
+
+         if ( s.op().selected_input( "mmap" ) ) {
+            s.report( benchmark, "mmap", data.size(), measure( benchmark, "mmap", s.op().repeat, [ & ](){ return parse_mmap< Rule >( file ); } ) );
+         }
+         if ( s.op().selected_input( "read" ) ) {
+            s.report( benchmark, "read", data.size(), measure( benchmark, "read", s.op().repeat, [ & ](){ return parse_read< Rule >( file ); } ) );
+         }
+         run_buffered< Rule >( s, benchmark, data, std::integral_constant< bool, Buffered >() );
+         std::remove( file.c_str() );
+      }
+
+   } // bench
+
+} // pegtl
+
+#endif
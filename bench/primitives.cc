@@ -0,0 +1,278 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <iostream>
+#include <exception>
+
+#include <pegtl.hh>
+
+#include "bench.hh"
+
+// Microbenchmarks for the primitive rules. Every rule is run from a memory
+// input on a best case, a worst case and a typical corpus; the benchmark
+// names are "rule/case". The best case is the input for which the rule does
+// the least work per byte, e.g. the first of the alternatives, long
+// repetitions or ASCII, the worst case the input for which it does the most,
+// e.g. the last of the alternatives, short repetitions with a high overhead
+// per iteration, or long UTF-8 sequences. Note that the typical cases, with
+// random input, can be the slowest due to branch mispredictions.
+
+namespace pegtl
+{
+   namespace bench
+   {
+      const char * const cases[] = { "best", "worst", "typical" };
+
+      template< typename F >
+      std::string generate( const std::size_t size, const F & f )
+      {
+         random r;
+         std::string o;
+         while ( o.size() < size ) {
+            f( r, o );
+         }
+         return o;
+      }
+
+      std::string letters( random & r, const char * chars, const std::size_t min, const std::size_t max )
+      {
+         std::string nrv;
+         const std::size_t n = std::strlen( chars );
+         for ( std::size_t i = min + r( max - min + 1 ); i; --i ) {
+            nrv += chars[ r( n ) ];
+         }
+         return nrv;
+      }
+
+      // one< 'a', ..., 'h' >
+
+      using one_rule = must< star< one< 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h' > >, eof >;
+
+      std::string one_corpus( const std::string & c, const std::size_t size )
+      {
+         if ( c == "typical" ) {
+            return generate( size, [ & ]( random & r, std::string & o ){ o += letters( r, "abcdefgh", 64, 64 ); } );
+         }
+         return std::string( size, ( c == "best" ) ? 'a' : 'h' );
+      }
+
+      // sor< one< 'a' >, ..., one< 'h' > >
+
+      using sor_rule = must< star< sor< one< 'a' >, one< 'b' >, one< 'c' >, one< 'd' >, one< 'e' >, one< 'f' >, one< 'g' >, one< 'h' > > >, eof >;
+
+      // ranges< 'a', 'z', 'A', 'Z', '0', '9', '_' >
+
+      using ranges_rule = must< star< ranges< 'a', 'z', 'A', 'Z', '0', '9', '_' > >, eof >;
+
+      std::string ranges_corpus( const std::string & c, const std::size_t size )
+      {
+         if ( c == "typical" ) {
+            return generate( size, [ & ]( random & r, std::string & o ){ o += letters( r, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_", 64, 64 ); } );
+         }
+         return std::string( size, ( c == "best" ) ? 'm' : '_' );
+      }
+
+      // string<> and istring<>, the worst case fails in the last character.
+
+      using string_rule = must< star< sor< string< 'k', 'e', 'y', 'w', 'o', 'r', 'd' >, any > >, eof >;
+      using istring_rule = must< star< sor< istring< 'k', 'e', 'y', 'w', 'o', 'r', 'd' >, any > >, eof >;
+
+      std::string string_corpus( const std::string & c, const std::size_t size )
+      {
+         if ( c == "typical" ) {
+            return generate( size, [ & ]( random & r, std::string & o ){ o += r( 4 ) ? letters( r, "abcdefghijklmnopqrstuvwxyz ", 1, 12 ) : "keyword"; } );
+         }
+         return generate( size, [ & ]( random &, std::string & o ){ o += ( c == "best" ) ? "keyword" : "keyworx"; } );
+      }
+
+      std::string istring_corpus( const std::string & c, const std::size_t size )
+      {
+         if ( c == "typical" ) {
+            return generate( size, [ & ]( random & r, std::string & o ){ o += r( 4 ) ? letters( r, "abcdefghijklmnopqrstuvwxyz ", 1, 12 ) : ( r( 2 ) ? "keyword" : "KeyWord" ); } );
+         }
+         return generate( size, [ & ]( random &, std::string & o ){ o += ( c == "best" ) ? "keyword" : "KEYWORX"; } );
+      }
+
+      // until<>, here for quoted strings; the worst case are empty strings.
+
+      using until_rule = must< star< one< '"' >, until< one< '"' > > >, eof >;
+
+      std::string until_corpus( const std::string & c, const std::size_t size )
+      {
+         return generate( size, [ & ]( random & r, std::string & o )
+            {
+               if ( c == "best" ) {
+                  o += '"' + std::string( 4096, 'x' ) + '"';
+               }
+               else if ( c == "worst" ) {
+                  o += "\"\"";
+               }
+               else {
+                  o += '"' + letters( r, "abcdefghijklmnopqrstuvwxyz ", 0, 40 ) + '"';
+               }
+            } );
+      }
+
+      // star<>, the worst case are the shortest repetitions of the inner star<>.
+
+      using star_rule = must< star< one< 'a' >, star< one< 'b' > > >, eof >;
+
+      std::string star_corpus( const std::string & c, const std::size_t size )
+      {
+         return generate( size, [ & ]( random & r, std::string & o )
+            {
+               o += 'a';
+               o += std::string( ( c == "best" ) ? 4096 : ( ( c == "worst" ) ? 0 : r( 16 ) ), 'b' );
+            } );
+      }
+
+      // rep_min_max<>
+
+      using rep_min_max_rule = must< star< rep_min_max< 2, 5, digit >, one< ',' > >, eof >;
+
+      std::string rep_min_max_corpus( const std::string & c, const std::size_t size )
+      {
+         return generate( size, [ & ]( random & r, std::string & o )
+            {
+               o += letters( r, "0123456789", ( c == "best" ) ? 5 : 2, ( c == "worst" ) ? 2 : 5 ) + ',';
+            } );
+      }
+
+      // list<> with and without padding.
+
+      using list_rule = must< list< plus< digit >, one< ',' > >, eof >;
+      using list_pad_rule = must< list< plus< digit >, one< ',' >, blank >, eof >;
+
+      std::string number_list( const std::string & c, const std::size_t size, const bool padded )
+      {
+         std::string o = "0";
+         random r;
+         while ( o.size() < size ) {
+            o += ( c == "best" ) ? ",12345678901234567890123456789012345678901234567890" : ( ( c == "worst" ) ? ",1" : ( ( padded && r( 2 ) ) ? ", " : "," ) + letters( r, "0123456789", 1, 10 ) );
+         }
+         return o;
+      }
+
+      std::string list_corpus( const std::string & c, const std::size_t size )
+      {
+         return number_list( c, size, false );
+      }
+
+      std::string list_pad_corpus( const std::string & c, const std::size_t size )
+      {
+         return number_list( c, size, true );
+      }
+
+      // pad<>, the worst case are single character identifiers.
+
+      using pad_rule = must< star< pad< identifier, blank > >, eof >;
+
+      std::string pad_corpus( const std::string & c, const std::size_t size )
+      {
+         return generate( size, [ & ]( random & r, std::string & o )
+            {
+               if ( c == "best" ) {
+                  o += std::string( 4096, 'x' ) + ' ';
+               }
+               else if ( c == "worst" ) {
+                  o += "x ";
+               }
+               else {
+                  o += letters( r, "abcdefghijklmnopqrstuvwxyz", 1, 12 ) + std::string( r( 3 ) + 1, ' ' );
+               }
+            } );
+      }
+
+      // identifier
+
+      using identifier_rule = must< list< identifier, one< ' ' > >, eof >;
+
+      std::string identifier_corpus( const std::string & c, const std::size_t size )
+      {
+         std::string o = "x";
+         random r;
+         while ( o.size() < size ) {
+            o += ' ' + ( ( c == "best" ) ? std::string( 4096, 'x' ) : ( ( c == "worst" ) ? std::string( "x" ) : letters( r, "abcdefghijklmnopqrstuvwxyz", 1, 1 ) + letters( r, "abcdefghijklmnopqrstuvwxyz_0123456789", 0, 15 ) ) );
+         }
+         return o;
+      }
+
+      // eol, the worst case are empty lines with CR LF.
+
+      using eol_rule = must< star< star< not_one< '\r', '\n' > >, eol >, eof >;
+
+      std::string eol_corpus( const std::string & c, const std::size_t size )
+      {
+         return generate( size, [ & ]( random & r, std::string & o )
+            {
+               if ( c == "best" ) {
+                  o += std::string( 4096, 'x' ) + '\n';
+               }
+               else if ( c == "worst" ) {
+                  o += "\r\n";
+               }
+               else {
+                  o += letters( r, "abcdefghijklmnopqrstuvwxyz ", 0, 80 ) + ( r( 2 ) ? "\n" : "\r\n" );
+               }
+            } );
+      }
+
+      // utf8::range<> and utf8::any, the worst case are four byte sequences.
+
+      using utf8_range_rule = must< star< utf8::range< 0x20, 0x10ffff > >, eof >;
+      using utf8_any_rule = must< star< utf8::any >, eof >;
+
+      std::string utf8_corpus( const std::string & c, const std::size_t size )
+      {
+         static const char * const chars[] = { "a", "b", " ", "e", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80" };
+         return generate( size, [ & ]( random & r, std::string & o )
+            {
+               o += ( c == "best" ) ? "a" : ( ( c == "worst" ) ? chars[ 6 ] : r.pick( chars, sizeof( chars ) / sizeof( chars[ 0 ] ) ) );
+            } );
+      }
+
+      template< typename Rule, typename Corpus >
+      void benchmark( session & s, const std::string & rule, const Corpus & corpus )
+      {
+         for ( const auto * c : cases ) {
+            const std::string name = rule + '/' + c;
+            if ( s.op().selected( name ) ) {
+               run_memory< Rule >( s, name, corpus( c, s.op().size ) );
+            }
+         }
+      }
+
+   } // bench
+
+} // pegtl
+
+int main( int argc, char ** argv )
+{
+   using namespace pegtl::bench;
+
+   session s( argc, argv );
+
+   try {
+      benchmark< one_rule >( s, "one", one_corpus );
+      benchmark< sor_rule >( s, "sor", one_corpus );
+      benchmark< ranges_rule >( s, "ranges", ranges_corpus );
+      benchmark< string_rule >( s, "string", string_corpus );
+      benchmark< istring_rule >( s, "istring", istring_corpus );
+      benchmark< until_rule >( s, "until", until_corpus );
+      benchmark< star_rule >( s, "star", star_corpus );
+      benchmark< rep_min_max_rule >( s, "rep_min_max", rep_min_max_corpus );
+      benchmark< list_rule >( s, "list", list_corpus );
+      benchmark< list_pad_rule >( s, "list_pad", list_pad_corpus );
+      benchmark< pad_rule >( s, "pad", pad_corpus );
+      benchmark< identifier_rule >( s, "identifier", identifier_corpus );
+      benchmark< eol_rule >( s, "eol", eol_corpus );
+      benchmark< utf8_range_rule >( s, "utf8::range", utf8_corpus );
+      benchmark< utf8_any_rule >( s, "utf8::any", utf8_corpus );
+   }
+   catch ( const std::exception & e ) {
+      std::cerr << argv[ 0 ] << ": " << e.what() << std::endl;
+      return 1;
+   }
+   return s.finish();
+}
@@ -17,100 +17,14 @@
 #include <pegtl/contrib/abnf.hh>
 #include <pegtl/analyze.hh>
 
+#include "abnf_grammar.hh"
+
 namespace pegtl
 {
    namespace abnf
    {
       namespace grammar
       {
-         // ABNF grammar according to RFC 5234, updated by RFC 7405, with
-         // the following differences:
-         //
-         // To form a C++ identifier from a rulename, all minuses are
-         // replaced with underscores.
-         //
-         // As C++ identifiers are case-sensitive, we remember the "correct"
-         // spelling from the first occurrence of a rulename, all other
-         // occurrences are automatically changed to that.
-         //
-         // Certain rulenames are reserved as their equivalent C++ identifier is
-         // reserved as a keyword, an alternative token, by the standard or
-         // for other, special reasons.
-         //
-         // When using numerical values (num-val, repeat), the values
-         // must be in the range of the corresponsing C++ data type.
-         //
-         // Remember we are defining a PEG, not a CFG. Simply copying some
-         // ABNF from somewhere might lead to surprising results as the
-         // alternations are now sequential, using the pegtl::sor<> rule.
-         //
-         // PEG also require two extensions: the and-predicate and the
-         // not-predicate. They are expressed by '&' and '!' respectively,
-         // being allowed (optionally, only one of them) before the
-         // repetition. You can use braces for more complex expressions.
-         //
-         // Finally, instead of the pre-defined CRLF sequence, we accept
-         // any type of line ending as a convencience extension:
-         struct CRLF : sor< abnf::CRLF, CR, LF > {};
-
-         // The rest is according to the RFC(s):
-         struct comment_cont : until< CRLF, sor< WSP, VCHAR > > {};
-         struct comment : if_must< one< ';' >, comment_cont > {};
-         struct c_nl : sor< comment, CRLF > {};
-         struct c_wsp : sor< WSP, seq< c_nl, WSP > > {};
-
-         struct rulename : seq< ALPHA, star< ranges< 'a', 'z', 'A', 'Z', '0', '9', '-' > > > {};
-
-         struct quoted_string_cont : until< DQUOTE, print > {};
-         struct quoted_string : if_must< DQUOTE, quoted_string_cont > {};
-         struct case_insensitive_string : seq< opt< istring< '%', 'i' > >, quoted_string > {};
-         struct case_sensitive_string : seq< istring< '%', 's' >, quoted_string > {};
-         struct char_val : sor< case_insensitive_string, case_sensitive_string > {};
-
-         struct prose_val_cont : until< one< '>' >, print > {};
-         struct prose_val : if_must< one< '<' >, prose_val_cont > {};
-
-         template< char First, typename Digit >
-         struct gen_val
-         {
-            struct value : plus< Digit > {};
-            struct range : if_must< one< '-' >, value > {};
-            struct next_value : must< value > {};
-            struct type : seq< istring< First >, must< value >, sor< range, star< one< '.' >, next_value > > > {};
-         };
-
-         using hex_val = gen_val< 'x', HEXDIG >;
-         using dec_val = gen_val< 'd', DIGIT >;
-         using bin_val = gen_val< 'b', BIT >;
-
-         struct num_val_choice : sor< bin_val::type, dec_val::type, hex_val::type > {};
-         struct num_val : if_must< one< '%' >, num_val_choice > {};
-
-         struct alternation;
-         struct option_close : one< ']' > {};
-         struct option : seq< one< '[' >, pad< must< alternation >, c_wsp >, must< option_close > > {};
-         struct group_close : one< ')' > {};
-         struct group : seq< one< '(' >, pad< must< alternation >, c_wsp >, must< group_close > > {};
-         struct rulename_val : rulename {};
-         struct element : sor< rulename_val, group, option, char_val, num_val, prose_val > {};
-
-         struct repeat : sor< seq< star< DIGIT >, one< '*' >, star< DIGIT > >, plus< DIGIT > > {};
-         struct repetition : seq< opt< repeat >, element > {};
-
-         struct and_predicate : if_must< one< '&' >, repetition > {};
-         struct not_predicate : if_must< one< '!' >, repetition > {};
-         struct predicate : sor< and_predicate, not_predicate, repetition > {};
-
-         struct push_stack : success {};
-         struct concatenation : seq< push_stack, list< predicate, plus< c_wsp > > > {};
-         struct alternation : seq< push_stack, list_must< concatenation, pad< one< '/' >, c_wsp > > > {};
-
-         struct defined_as_op : sor< string< '=', '/' >, one< '=' > > {};
-         struct defined_as : pad< defined_as_op, c_wsp > {};
-         struct rule : seq< push_stack, if_must< rulename, defined_as, alternation >, star< c_wsp >, must< c_nl > > {};
-         struct rulelist : until< eof, sor< seq< star< c_wsp >, c_nl >, must< rule > > > {};
-
-         // end of grammar
 
          template< typename Rule >
          struct error_control
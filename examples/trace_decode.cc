@@ -0,0 +1,46 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include <pegtl/contrib/binary_trace.hh>
+
+// Prints a trace written by pegtl::binary_trace::write(), indented by the
+// nesting of the rules, optionally only the events for rules whose name
+// contains the filter string. Since the trace usually starts somewhere in
+// the middle of a parsing run the nesting is relative to the first event.
+
+int main( int argc, char ** argv )
+{
+   if ( ( argc < 2 ) || ( argc > 3 ) ) {
+      std::cerr << "usage: " << argv[ 0 ] << " <trace file> [filter]" << std::endl;
+      return 1;
+   }
+   std::ifstream file( argv[ 1 ], std::ios::binary );
+   std::vector< std::string > names;
+   std::vector< pegtl::trace_record > records;
+
+   if ( ! pegtl::binary_trace::read( file, names, records ) ) {
+      std::cerr << "invalid trace file " << argv[ 1 ] << std::endl;
+      return 1;
+   }
+   const std::string filter = ( argc == 3 ) ? argv[ 2 ] : "";
+   static const char * events[] = { "  start", "success", "failure", "  raise" };
+   std::size_t depth = 0;
+
+   for ( const auto & r : records ) {
+      if ( ( depth > 0 ) && ( r.event != pegtl::trace_event::START ) && ( r.event != pegtl::trace_event::RAISE ) ) {
+         --depth;
+      }
+      if ( names[ r.rule ].find( filter ) != std::string::npos ) {
+         std::cout << r.line << ':' << r.byte_in_line << ' ' << events[ int( r.event ) ] << ' ' << std::string( 2 * depth, ' ' ) << names[ r.rule ] << '\n';
+      }
+      if ( r.event == pegtl::trace_event::START ) {
+         ++depth;
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,835 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_ANALYSIS_ANALYZE_GRAMMAR_HH
+#define PEGTL_ANALYSIS_ANALYZE_GRAMMAR_HH
+
+#include <map>
+#include <bitset>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <ostream>
+#include <utility>
+#include <initializer_list>
+
+#include "../internal/demangle.hh"
+#include "../internal/rules.hh"
+#include "../internal/peek_char.hh"
+#include "../internal/peek_utf8.hh"
+#include "../internal/peek_utf16.hh"
+#include "../internal/peek_utf32.hh"
+
+#include "generic.hh"
+#include "byte_set.hh"
+#include "rule_properties.hh"
+
+namespace pegtl
+{
+   namespace analysis
+   {
+      // A potential backtracking or performance problem found by analyze_grammar:
+      //   "sor-overlap"          two alternatives of a sor<> can start with the same bytes (first),
+      //   "loop-nullable-body"   the body of a star<> or plus<> can succeed without consuming input,
+      //   "loop-unbounded-body"  the body of a star<> or plus<> can fail after consuming an unbounded
+      //                          amount of input, which is then matched again by what follows,
+      //   "until-nullable-body"  the body of an until<> can succeed without consuming input,
+      //   "until-overlap"        the non-terminal condition of an until<> can start with the same
+      //                          bytes as the body (first), i.e. it is tried and fails at those,
+      //   "until-unbounded-condition"  the condition of an until<>, which is tried at every
+      //                          position, can consume an unbounded amount of input.
+      // The rules are the sub-rules involved, e.g. the two alternatives of the sor<>.
+
+      struct grammar_warning
+      {
+         std::string kind;
+         std::string rule;
+         std::vector< std::string > rules;
+         std::bitset< 256 > first;
+      };
+
+      inline std::size_t saturating_add( const std::size_t a, const std::size_t b )
+      {
+         return ( ( a == rule_properties::unbounded ) || ( b == rule_properties::unbounded ) || ( a + b < a ) ) ? rule_properties::unbounded : ( a + b );
+      }
+
+      inline std::size_t saturating_multiply( const std::size_t a, const std::size_t n )
+      {
+         if ( ( a == 0 ) || ( n == 0 ) ) {
+            return 0;
+         }
+         return ( ( a == rule_properties::unbounded ) || ( n == rule_properties::unbounded ) || ( a > rule_properties::unbounded / n ) ) ? rule_properties::unbounded : ( a * n );
+      }
+
+      inline std::size_t utf8_length( const char32_t c )
+      {
+         return ( c < 0x80 ) ? 1 : ( c < 0x800 ) ? 2 : ( c < 0x10000 ) ? 3 : 4;
+      }
+
+      // Describes single character rules by testing the predicate F with all
+      // characters; for UTF-16, UTF-32 and unknown Peek classes only the
+      // length is known.
+
+      template< std::size_t Min, std::size_t Max >
+      struct peek_terminal_units
+      {
+         template< typename F >
+         static void describe( rule_properties & p, const F & )
+         {
+            p.first.set();
+            p.min_length = Min;
+            p.max_length = Max;
+         }
+      };
+
+      template< typename Peek >
+      struct peek_terminal
+            : peek_terminal_units< 1, rule_properties::unbounded > {};
+
+      template<>
+      struct peek_terminal< internal::peek_char >
+      {
+         template< typename F >
+         static void describe( rule_properties & p, const F & f )
+         {
+            for ( unsigned b = 0; b < 256; ++b ) {
+               if ( f( char( b ) ) ) {
+                  p.first.set( b );
+                  p.min_length = p.max_length = 1;
+               }
+            }
+         }
+      };
+
+      template<>
+      struct peek_terminal< internal::peek_utf8 >
+      {
+         template< typename F >
+         static void describe( rule_properties & p, const F & f )
+         {
+            for ( char32_t c = 0; c <= 0x10ffff; ++c ) {
+               if ( f( c ) ) {
+                  const std::size_t n = utf8_length( c );
+                  p.first.set( utf8_lead( c ) );
+                  p.min_length = ( n < p.min_length ) ? n : p.min_length;
+                  p.max_length = ( n > p.max_length ) ? n : p.max_length;
+               }
+            }
+         }
+      };
+
+      template<>
+      struct peek_terminal< internal::peek_utf16 >
+            : peek_terminal_units< 2, 4 > {};
+
+      template<>
+      struct peek_terminal< internal::peek_utf32 >
+            : peek_terminal_units< 4, 4 > {};
+
+      class analyze_grammar_impl
+      {
+      public:
+         using map_t = std::map< std::string, rule_properties >;
+
+         const map_t & rules() const
+         {
+            return m_rules;
+         }
+
+         const std::vector< grammar_warning > & warnings() const
+         {
+            return m_warnings;
+         }
+
+         // Writes the rules and warnings as one JSON object; "first" is written
+         // as character class, "min" is null for rules that can never succeed,
+         // "max" is null for rules that can consume an unbounded amount of input.
+
+         void write_json( std::ostream & o ) const
+         {
+            static const char * const kinds[] = { "terminal", "predicate", "sequence", "choice", "loop", "until" };
+            o << "{\n\"rules\": [";
+            const char * separator = "\n";
+            for ( const auto & i : m_rules ) {
+               const rule_properties & p = i.second;
+               o << separator << "{ \"rule\": ";
+               write_string( o, i.first );
+               o << ", \"kind\": \"" << kinds[ int( p.kind ) ] << "\", \"nullable\": " << ( p.nullable ? "true" : "false" ) << ", \"min\": ";
+               write_length( o, p.min_length );
+               o << ", \"max\": ";
+               write_length( o, p.max_length );
+               o << ", \"first\": ";
+               write_string( o, character_class( p.first ) );
+               o << ", \"rules\": ";
+               write_strings( o, p.rules );
+               o << " }";
+               separator = ",\n";
+            }
+            o << "\n],\n\"warnings\": [";
+            separator = "\n";
+            for ( const auto & w : m_warnings ) {
+               o << separator << "{ \"kind\": \"" << w.kind << "\", \"rule\": ";
+               write_string( o, w.rule );
+               o << ", \"rules\": ";
+               write_strings( o, w.rules );
+               if ( w.first.any() ) {
+                  o << ", \"first\": ";
+                  write_string( o, character_class( w.first ) );
+               }
+               o << " }";
+               separator = ",\n";
+            }
+            o << "\n]\n}\n";
+         }
+
+         static std::string character_class( const std::bitset< 256 > & s )
+         {
+            std::string nrv = "[";
+            for ( unsigned b = 0; b < 256; ++b ) {
+               if ( s.test( b ) ) {
+                  unsigned e = b;
+                  while ( ( e < 255 ) && s.test( e + 1 ) ) {
+                     ++e;
+                  }
+                  append_class_char( nrv, b );
+                  if ( e > b ) {
+                     if ( e > b + 1 ) {
+                        nrv += '-';
+                     }
+                     append_class_char( nrv, e );
+                  }
+                  b = e;
+               }
+            }
+            return nrv + ']';
+         }
+
+      protected:
+         map_t m_rules;
+         std::vector< grammar_warning > m_warnings;
+
+         template< typename Rule >
+         std::string insert()
+         {
+            const auto r = m_rules.insert( map_t::value_type( internal::demangle< Rule >(), rule_properties( type_of( static_cast< const typename Rule::analyze_t * >( nullptr ) ) ) ) );
+            if ( r.second && ( ! describe( r.first->second, static_cast< const Rule * >( nullptr ) ) ) ) {
+               structure( r.first->second, static_cast< const typename Rule::analyze_t * >( nullptr ) );
+            }
+            return r.first->first;
+         }
+
+         template< rule_type Type, typename ... Rules >
+         static rule_type type_of( const generic< Type, Rules ... > * )
+         {
+            return Type;
+         }
+
+         static rule_type type_of( const void * )
+         {
+            return rule_type::ANY;
+         }
+
+         // Rules that are not described below get their structure from their
+         // analyze_t; without sub-rules anything is assumed to be possible.
+
+         template< rule_type Type, typename ... Rules >
+         void structure( rule_properties & p, const generic< Type, Rules ... > * )
+         {
+            p.rules = { insert< Rules >() ... };
+            if ( p.rules.empty() && ( ( Type == rule_type::ANY ) || ( Type == rule_type::OPT ) ) ) {
+               unknown( p );
+            }
+            else if ( Type == rule_type::SOR ) {
+               p.kind = rule_kind::CHOICE;
+            }
+            else if ( Type == rule_type::OPT ) {
+               p.repeat_min = 0;
+            }
+         }
+
+         void structure( rule_properties & p, const void * )
+         {
+            unknown( p );
+         }
+
+         static void unknown( rule_properties & p )
+         {
+            p.kind = rule_kind::TERMINAL;
+            p.nullable = ( p.type != rule_type::ANY );
+            p.min_length = p.nullable ? 0 : 1;
+            p.max_length = rule_properties::unbounded;
+            p.first.set();
+         }
+
+         static void terminal( rule_properties & p, const std::size_t length )
+         {
+            p.kind = rule_kind::TERMINAL;
+            p.nullable = ( length == 0 );
+            p.min_length = p.max_length = length;
+         }
+
+         static void predicate( rule_properties & p )
+         {
+            p.kind = rule_kind::PREDICATE;
+            p.nullable = true;
+            p.min_length = p.max_length = 0;
+         }
+
+         static void failure( rule_properties & p )
+         {
+            p.kind = rule_kind::TERMINAL;
+         }
+
+         template< typename ... Rules >
+         void sequence( rule_properties & p, const rule_kind kind, const std::size_t repeat_min, const std::size_t repeat_max )
+         {
+            p.kind = kind;
+            p.repeat_min = repeat_min;
+            p.repeat_max = repeat_max;
+            p.rules = { insert< Rules >() ... };
+         }
+
+         static bool describe( rule_properties &, const void * )
+         {
+            return false;
+         }
+
+         template< internal::result_on_found R, typename Peek, typename Peek::data_t ... Cs >
+         bool describe( rule_properties & p, const internal::one< R, Peek, Cs ... > * )
+         {
+            p.kind = rule_kind::TERMINAL;
+            peek_terminal< Peek >::describe( p, []( const typename Peek::data_t c ){ return internal::contains( c, { Cs ... } ) == bool( R ); } );
+            return true;
+         }
+
+         template< internal::result_on_found R, typename Peek, typename Peek::data_t Lo, typename Peek::data_t Hi >
+         bool describe( rule_properties & p, const internal::range< R, Peek, Lo, Hi > * )
+         {
+            using range_t = internal::range< R, Peek, Lo, Hi >;
+            p.kind = rule_kind::TERMINAL;
+            peek_terminal< Peek >::describe( p, []( const typename Peek::data_t c ){ return ( range_t::dummy_less_or_equal( Lo, c ) && range_t::dummy_less_or_equal( c, Hi ) ) == bool( R ); } );
+            return true;
+         }
+
+         template< typename Peek, typename Peek::data_t ... Cs >
+         bool describe( rule_properties & p, const internal::ranges< Peek, Cs ... > * )
+         {
+            p.kind = rule_kind::TERMINAL;
+            peek_terminal< Peek >::describe( p, []( const typename Peek::data_t c ){ return internal::ranges_impl< typename Peek::data_t, Cs ... >::match( c ); } );
+            return true;
+         }
+
+         template< typename Peek >
+         bool describe( rule_properties & p, const internal::any< Peek > * )
+         {
+            p.kind = rule_kind::TERMINAL;
+            peek_terminal< Peek >::describe( p, []( const typename Peek::data_t ){ return true; } );
+            return true;
+         }
+
+         template< char ... Cs >
+         bool describe( rule_properties & p, const internal::string< Cs ... > * )
+         {
+            const std::initializer_list< char > l = { Cs ... };
+            terminal( p, l.size() );
+            if ( l.size() ) {
+               p.first.set( ( unsigned char )( * l.begin() ) );
+            }
+            return true;
+         }
+
+         template< char ... Cs >
+         bool describe( rule_properties & p, const internal::istring< Cs ... > * )
+         {
+            const std::initializer_list< char > l = { Cs ... };
+            terminal( p, l.size() );
+            if ( l.size() ) {
+               const char c = * l.begin();
+               p.first.set( ( unsigned char )( c ) );
+               if ( ( ( c | 0x20 ) >= 'a' ) && ( ( c | 0x20 ) <= 'z' ) ) {
+                  p.first.set( ( unsigned char )( c ^ 0x20 ) );
+               }
+            }
+            return true;
+         }
+
+         template< unsigned Num >
+         bool describe( rule_properties & p, const internal::bytes< Num > * )
+         {
+            terminal( p, Num );
+            if ( Num ) {
+               p.first.set();
+            }
+            return true;
+         }
+
+         bool describe( rule_properties & p, const internal::eol * )
+         {
+            terminal( p, 1 );
+            p.max_length = 2;
+            p.first.set( '\r' );
+            p.first.set( '\n' );
+            return true;
+         }
+
+         bool describe( rule_properties & p, const internal::eolf * )
+         {
+            terminal( p, 0 );
+            p.max_length = 2;
+            p.first.set( '\r' );
+            p.first.set( '\n' );
+            return true;
+         }
+
+         bool describe( rule_properties & p, const internal::eof * )
+         {
+            predicate( p );
+            return true;
+         }
+
+         bool describe( rule_properties & p, const internal::discard * )
+         {
+            predicate( p );
+            return true;
+         }
+
+         template< unsigned Amount >
+         bool describe( rule_properties & p, const internal::require< Amount > * )
+         {
+            predicate( p );
+            return true;
+         }
+
+         template< bool Result >
+         bool describe( rule_properties & p, const internal::trivial< Result > * )
+         {
+            if ( Result ) {
+               predicate( p );
+            }
+            else {
+               failure( p );
+            }
+            return true;
+         }
+
+         template< typename T >
+         bool describe( rule_properties & p, const internal::raise< T > * )
+         {
+            failure( p );
+            return true;
+         }
+
+         template< typename ... Rules >
+         bool describe( rule_properties & p, const internal::at< Rules ... > * )
+         {
+            p.rules = { insert< Rules >() ... };
+            predicate( p );
+            return true;
+         }
+
+         template< typename ... Rules >
+         bool describe( rule_properties & p, const internal::not_at< Rules ... > * )
+         {
+            p.rules = { insert< Rules >() ... };
+            if ( p.rules.empty() ) {
+               failure( p );
+            }
+            else {
+               predicate( p );
+               p.negated = true;
+            }
+            return true;
+         }
+
+         // The single rule versions of seq<>, must<> and minus<> forward the
+         // analyze_t of the sub-rule, minus<> is approximated by its first rule.
+
+         template< typename Rule >
+         bool describe( rule_properties & p, const internal::seq< Rule > * )
+         {
+            sequence< Rule >( p, rule_kind::SEQUENCE, 1, 1 );
+            return true;
+         }
+
+         template< typename Rule >
+         bool describe( rule_properties & p, const internal::must< Rule > * )
+         {
+            sequence< Rule >( p, rule_kind::SEQUENCE, 1, 1 );
+            p.raises = true;
+            return true;
+         }
+
+         template< typename M, typename S >
+         bool describe( rule_properties & p, const internal::minus< M, S > * )
+         {
+            sequence< M >( p, rule_kind::SEQUENCE, 1, 1 );
+            return true;
+         }
+
+         template< unsigned Num, typename ... Rules >
+         bool describe( rule_properties & p, const internal::rep< Num, Rules ... > * )
+         {
+            sequence< Rules ... >( p, rule_kind::SEQUENCE, Num, Num );
+            return true;
+         }
+
+         template< unsigned Min, unsigned Max, typename ... Rules >
+         bool describe( rule_properties & p, const internal::rep_min_max< Min, Max, Rules ... > * )
+         {
+            sequence< Rules ... >( p, rule_kind::SEQUENCE, Min, Max );
+            if ( p.rules.empty() ) {
+               failure( p );
+            }
+            return true;
+         }
+
+         template< unsigned Max, typename ... Rules >
+         bool describe( rule_properties & p, const internal::rep_opt< Max, Rules ... > * )
+         {
+            sequence< Rules ... >( p, rule_kind::SEQUENCE, 0, Max );
+            return true;
+         }
+
+         template< typename Rule, typename ... Rules >
+         bool describe( rule_properties & p, const internal::star< Rule, Rules ... > * )
+         {
+            sequence< Rule, Rules ... >( p, rule_kind::LOOP, 0, rule_properties::unbounded );
+            return true;
+         }
+
+         template< typename Rule, typename ... Rules >
+         bool describe( rule_properties & p, const internal::plus< Rule, Rules ... > * )
+         {
+            sequence< Rule, Rules ... >( p, rule_kind::LOOP, 1, rule_properties::unbounded );
+            return true;
+         }
+
+         template< typename Cond >
+         bool describe( rule_properties & p, const internal::until< Cond > * )
+         {
+            sequence< Cond, internal::bytes< 1 > >( p, rule_kind::UNTIL, 1, 1 );
+            return true;
+         }
+
+         template< typename Cond, typename Rule, typename ... Rules >
+         bool describe( rule_properties & p, const internal::until< Cond, Rule, Rules ... > * )
+         {
+            sequence< Cond, Rule, Rules ... >( p, rule_kind::UNTIL, 1, 1 );
+            return true;
+         }
+
+         const rule_properties & find( const std::string & name ) const
+         {
+            return m_rules.find( name )->second;
+         }
+
+         // Returns the set of bytes at which the predicate p can succeed, which
+         // is only known for at<> and not_at<> of a single byte terminal.
+
+         std::bitset< 256 > guard( const rule_properties & p ) const
+         {
+            if ( p.rules.size() == 1 ) {
+               const rule_properties & q = find( p.rules[ 0 ] );
+               if ( ( q.kind == rule_kind::TERMINAL ) && ( q.min_length == 1 ) && ( q.max_length == 1 ) ) {
+                  return p.negated ? ~q.first : q.first;
+               }
+            }
+            return ~std::bitset< 256 >();
+         }
+
+         // Combines the rules from begin to end as conjunction into nrv, the
+         // maximum length is only computed when with_max is true.
+
+         void conjunction( rule_properties & nrv, const std::size_t begin, const std::vector< std::string > & rules, const bool with_max ) const
+         {
+            nrv.nullable = true;
+            nrv.min_length = nrv.max_length = 0;
+            bool prefix = true;
+            auto mask = ~std::bitset< 256 >();
+            for ( std::size_t i = begin; i < rules.size(); ++i ) {
+               const rule_properties & q = find( rules[ i ] );
+               if ( ! q.can_succeed() ) {
+                  nrv.nullable = false;
+                  nrv.min_length = rule_properties::unbounded;
+                  nrv.max_length = 0;
+                  nrv.first.reset();
+                  return;
+               }
+               if ( q.kind == rule_kind::PREDICATE ) {
+                  mask &= guard( q );
+               }
+               if ( prefix ) {
+                  nrv.first |= q.first & mask;
+               }
+               prefix = prefix && q.nullable;
+               nrv.nullable = nrv.nullable && q.nullable;
+               nrv.min_length = saturating_add( nrv.min_length, q.min_length );
+               if ( with_max ) {
+                  nrv.max_length = saturating_add( nrv.max_length, q.max_length );
+               }
+            }
+         }
+
+         // One step of the computation of nullable, min_length and first, or of
+         // max_length; returns whether anything changed.
+
+         bool update( rule_properties & p, const bool with_max ) const
+         {
+            rule_properties n( p.type );
+            switch ( p.kind ) {
+               case rule_kind::TERMINAL:
+               case rule_kind::PREDICATE:
+                  return false;
+               case rule_kind::SEQUENCE:
+               case rule_kind::LOOP:
+                  conjunction( n, 0, p.rules, with_max );
+                  if ( p.repeat_max == 0 ) {
+                     n.first.reset();
+                     n.max_length = 0;
+                  }
+                  n.max_length = n.can_succeed() ? saturating_multiply( n.max_length, p.repeat_max ) : 0;
+                  if ( p.repeat_min == 0 ) {
+                     n.nullable = true;
+                     n.min_length = 0;
+                  }
+                  else {
+                     n.min_length = saturating_multiply( n.min_length, p.repeat_min );
+                  }
+                  break;
+               case rule_kind::CHOICE:
+                  n.min_length = rule_properties::unbounded;
+                  n.max_length = 0;
+                  for ( const auto & r : p.rules ) {
+                     const rule_properties & q = find( r );
+                     if ( q.can_succeed() ) {
+                        n.nullable = n.nullable || q.nullable;
+                        n.min_length = ( q.min_length < n.min_length ) ? q.min_length : n.min_length;
+                        n.max_length = ( q.max_length > n.max_length ) ? q.max_length : n.max_length;
+                        n.first |= q.first;
+                     }
+                  }
+                  break;
+               case rule_kind::UNTIL: {
+                  const rule_properties & c = find( p.rules[ 0 ] );
+                  conjunction( n, 1, p.rules, with_max );
+                  if ( c.can_succeed() ) {
+                     n.max_length = ( n.can_succeed() && ( n.max_length != 0 ) ) ? rule_properties::unbounded : c.max_length;
+                     n.first = c.first | ( n.can_succeed() ? n.first : std::bitset< 256 >() );
+                     n.nullable = c.nullable;
+                     n.min_length = c.min_length;
+                  }
+                  else {
+                     n.nullable = false;
+                     n.min_length = rule_properties::unbounded;
+                     n.max_length = 0;
+                     n.first.reset();
+                  }
+               }  break;
+            }
+            if ( with_max ) {
+               if ( n.max_length == p.max_length ) {
+                  return false;
+               }
+               p.max_length = n.max_length;
+               return true;
+            }
+            if ( ( n.nullable == p.nullable ) && ( n.min_length == p.min_length ) && ( n.first == p.first ) ) {
+               return false;
+            }
+            p.nullable = n.nullable;
+            p.min_length = n.min_length;
+            p.first = n.first;
+            return true;
+         }
+
+         // The maximum length of rules in cycles that consume input grows with
+         // every round, it is unbounded for all rules that still change after
+         // as many rounds as there are rules.
+
+         void compute()
+         {
+            for ( bool changed = true; changed; ) {
+               changed = false;
+               for ( auto & i : m_rules ) {
+                  changed |= update( i.second, false );
+               }
+            }
+            for ( std::size_t round = 0; ; ++round ) {
+               bool changed = false;
+               for ( auto & i : m_rules ) {
+                  if ( update( i.second, true ) ) {
+                     changed = true;
+                     if ( round > m_rules.size() ) {
+                        i.second.max_length = rule_properties::unbounded;
+                     }
+                  }
+               }
+               if ( ! changed ) {
+                  break;
+               }
+            }
+         }
+
+         // Whether the conjunction of the rules can fail after an unbounded
+         // amount of input was consumed, i.e. whether a rule that can fail
+         // follows one with unbounded maximum length; single sequences are
+         // looked into.
+
+         bool fails_after_unbounded( const std::vector< std::string > & rules ) const
+         {
+            if ( rules.size() == 1 ) {
+               const rule_properties & q = find( rules[ 0 ] );
+               return ( q.kind == rule_kind::SEQUENCE ) && ( q.repeat_min == 1 ) && ( q.repeat_max == 1 ) && fails_after_unbounded( q.rules );
+            }
+            std::size_t length = 0;
+            for ( const auto & r : rules ) {
+               const rule_properties & q = find( r );
+               if ( ( length == rule_properties::unbounded ) && ( ! q.nullable ) && ( ! q.raises ) ) {
+                  return true;
+               }
+               length = saturating_add( length, q.max_length );
+            }
+            return false;
+         }
+
+         void warn( const char * kind, const std::string & rule, std::vector< std::string > rules, const std::bitset< 256 > & first = std::bitset< 256 >() )
+         {
+            m_warnings.push_back( grammar_warning{ kind, rule, std::move( rules ), first } );
+         }
+
+         void check()
+         {
+            for ( const auto & i : m_rules ) {
+               const rule_properties & p = i.second;
+               switch ( p.kind ) {
+                  case rule_kind::CHOICE:
+                     for ( std::size_t a = 0; a < p.rules.size(); ++a ) {
+                        for ( std::size_t b = a + 1; b < p.rules.size(); ++b ) {
+                           const auto overlap = find( p.rules[ a ] ).first & find( p.rules[ b ] ).first;
+                           if ( overlap.any() ) {
+                              warn( "sor-overlap", i.first, { p.rules[ a ], p.rules[ b ] }, overlap );
+                           }
+                        }
+                     }
+                     break;
+                  case rule_kind::LOOP: {
+                     rule_properties body( p.type );
+                     conjunction( body, 0, p.rules, true );
+                     if ( body.nullable ) {
+                        warn( "loop-nullable-body", i.first, p.rules );
+                     }
+                     else if ( fails_after_unbounded( p.rules ) ) {
+                        warn( "loop-unbounded-body", i.first, p.rules );
+                     }
+                  }  break;
+                  case rule_kind::UNTIL: {
+                     const rule_properties & c = find( p.rules[ 0 ] );
+                     rule_properties body( p.type );
+                     conjunction( body, 1, p.rules, true );
+                     const std::vector< std::string > rules( p.rules.begin() + 1, p.rules.end() );
+                     if ( body.nullable ) {
+                        warn( "until-nullable-body", i.first, rules );
+                     }
+                     if ( c.kind != rule_kind::TERMINAL ) {
+                        const auto overlap = c.first & body.first;
+                        if ( overlap.any() ) {
+                           warn( "until-overlap", i.first, p.rules, overlap );
+                        }
+                     }
+                     if ( c.max_length == rule_properties::unbounded ) {
+                        warn( "until-unbounded-condition", i.first, { p.rules[ 0 ] } );
+                     }
+                  }  break;
+                  default:
+                     break;
+               }
+            }
+         }
+
+      private:
+         static void append_class_char( std::string & s, const unsigned b )
+         {
+            if ( ( b > 0x20 ) && ( b < 0x7f ) ) {
+               if ( ( b == '\\' ) || ( b == ']' ) || ( b == '[' ) || ( b == '-' ) || ( b == '^' ) ) {
+                  s += '\\';
+               }
+               s += char( b );
+            }
+            else {
+               char buffer[ 8 ];
+               std::snprintf( buffer, sizeof( buffer ), "\\x%02x", b );
+               s += buffer;
+            }
+         }
+
+         static void write_length( std::ostream & o, const std::size_t n )
+         {
+            if ( n == rule_properties::unbounded ) {
+               o << "null";
+            }
+            else {
+               o << n;
+            }
+         }
+
+         static void write_string( std::ostream & o, const std::string & s )
+         {
+            o << '"';
+            for ( const char c : s ) {
+               if ( ( c == '"' ) || ( c == '\\' ) ) {
+                  o << '\\' << c;
+               }
+               else if ( ( unsigned char )( c ) < 0x20 ) {
+                  char buffer[ 8 ];
+                  std::snprintf( buffer, sizeof( buffer ), "\\u%04x", unsigned( c ) );
+                  o << buffer;
+               }
+               else {
+                  o << c;
+               }
+            }
+            o << '"';
+         }
+
+         static void write_strings( std::ostream & o, const std::vector< std::string > & v )
+         {
+            o << '[';
+            for ( std::size_t i = 0; i < v.size(); ++i ) {
+               o << ( i ? ", " : " " );
+               write_string( o, v[ i ] );
+            }
+            o << ( v.empty() ? "]" : " ]" );
+         }
+      };
+
+      // Computes the properties of all rules of the Grammar, see rule_properties,
+      // and finds the alternatives of sor<> and the bodies of star<>, plus<> and
+      // until<> that are likely to cause backtracking, see grammar_warning.
+      // Rules that are not known to the analysis are treated conservatively
+      // as possibly consuming any input of any length.
+
+      template< typename Grammar >
+      class analyze_grammar
+            : public analyze_grammar_impl
+      {
+      public:
+         analyze_grammar()
+         {
+            insert< Grammar >();
+            compute();
+            check();
+         }
+
+         template< typename Rule >
+         const rule_properties & get() const
+         {
+            return find( internal::demangle< Rule >() );
+         }
+      };
+
+   } // analysis
+
+} // pegtl
+
+#endif
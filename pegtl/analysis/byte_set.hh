@@ -0,0 +1,142 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_ANALYSIS_BYTE_SET_HH
+#define PEGTL_ANALYSIS_BYTE_SET_HH
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+namespace pegtl
+{
+   namespace analysis
+   {
+      constexpr std::size_t popcount64( const std::uint64_t w )
+      {
+         return w ? ( 1 + popcount64( w & ( w - 1 ) ) ) : 0;
+      }
+
+      // A set of bytes that can be used in constant expressions.
+
+      struct byte_set
+      {
+         std::uint64_t w0;
+         std::uint64_t w1;
+         std::uint64_t w2;
+         std::uint64_t w3;
+
+         constexpr std::uint64_t word( const unsigned i ) const
+         {
+            return ( i == 0 ) ? w0 : ( i == 1 ) ? w1 : ( i == 2 ) ? w2 : w3;
+         }
+
+         constexpr bool test( const unsigned char c ) const
+         {
+            return ( ( word( c >> 6 ) >> ( c & 63 ) ) & 1 ) != 0;
+         }
+
+         constexpr bool any() const
+         {
+            return ( w0 | w1 | w2 | w3 ) != 0;
+         }
+
+         constexpr std::size_t count() const
+         {
+            return popcount64( w0 ) + popcount64( w1 ) + popcount64( w2 ) + popcount64( w3 );
+         }
+
+         constexpr byte_set operator| ( const byte_set & s ) const
+         {
+            return byte_set{ w0 | s.w0, w1 | s.w1, w2 | s.w2, w3 | s.w3 };
+         }
+
+         constexpr byte_set operator& ( const byte_set & s ) const
+         {
+            return byte_set{ w0 & s.w0, w1 & s.w1, w2 & s.w2, w3 & s.w3 };
+         }
+
+         constexpr byte_set operator~ () const
+         {
+            return byte_set{ ~w0, ~w1, ~w2, ~w3 };
+         }
+
+         constexpr bool operator== ( const byte_set & s ) const
+         {
+            return ( w0 == s.w0 ) && ( w1 == s.w1 ) && ( w2 == s.w2 ) && ( w3 == s.w3 );
+         }
+
+         std::bitset< 256 > bits() const
+         {
+            std::bitset< 256 > nrv;
+            for ( unsigned i = 0; i < 256; ++i ) {
+               nrv.set( i, test( ( unsigned char )( i ) ) );
+            }
+            return nrv;
+         }
+      };
+
+      constexpr byte_set byte_none()
+      {
+         return byte_set{ 0, 0, 0, 0 };
+      }
+
+      constexpr byte_set byte_all()
+      {
+         return ~byte_none();
+      }
+
+      constexpr std::uint64_t byte_word( const unsigned char c, const unsigned i )
+      {
+         return ( ( c >> 6 ) == i ) ? ( std::uint64_t( 1 ) << ( c & 63 ) ) : 0;
+      }
+
+      constexpr byte_set byte_bit( const unsigned char c )
+      {
+         return byte_set{ byte_word( c, 0 ), byte_word( c, 1 ), byte_word( c, 2 ), byte_word( c, 3 ) };
+      }
+
+      // The bits of the word starting at byte value base that are in [ lo, hi ].
+
+      constexpr std::uint64_t range_word( const unsigned lo, const unsigned hi, const unsigned base )
+      {
+         return ( ( lo > hi ) || ( hi < base ) || ( lo > base + 63 ) ) ? 0 : ( ( ( ( hi >= base + 63 ) ? ~std::uint64_t( 0 ) : ( ( std::uint64_t( 1 ) << ( hi - base + 1 ) ) - 1 ) ) ) & ~( ( lo <= base ) ? std::uint64_t( 0 ) : ( ( std::uint64_t( 1 ) << ( lo - base ) ) - 1 ) ) );
+      }
+
+      constexpr byte_set byte_range( const unsigned lo, const unsigned hi )
+      {
+         return byte_set{ range_word( lo, hi, 0 ), range_word( lo, hi, 64 ), range_word( lo, hi, 128 ), range_word( lo, hi, 192 ) };
+      }
+
+      // A range of char values as compared by the rules, i.e. for a signed
+      // char a range from negative to positive values wraps around.
+
+      constexpr byte_set char_range( const char lo, const char hi )
+      {
+         return ( lo > hi ) ? byte_none() : ( ( unsigned char )( lo ) > ( unsigned char )( hi ) ) ? ( byte_range( ( unsigned char )( lo ), 255 ) | byte_range( 0, ( unsigned char )( hi ) ) ) : byte_range( ( unsigned char )( lo ), ( unsigned char )( hi ) );
+      }
+
+      constexpr unsigned char utf8_lead( const char32_t c )
+      {
+         return ( c < 0x80 ) ? ( unsigned char )( c ) : ( c < 0x800 ) ? ( unsigned char )( 0xc0 | ( c >> 6 ) ) : ( c < 0x10000 ) ? ( unsigned char )( 0xe0 | ( c >> 12 ) ) : ( unsigned char )( 0xf0 | ( c >> 18 ) );
+      }
+
+      // The first bytes of the UTF-8 encodings of the code points in [ lo, hi ],
+      // computed separately for every encoded length, the first byte of which
+      // is monotonic in the code point.
+
+      constexpr byte_set utf8_class( const char32_t lo, const char32_t hi, const char32_t first, const char32_t last )
+      {
+         return ( ( hi < first ) || ( lo > last ) ) ? byte_none() : byte_range( utf8_lead( ( lo > first ) ? lo : first ), utf8_lead( ( hi < last ) ? hi : last ) );
+      }
+
+      constexpr byte_set utf8_range( const char32_t lo, const char32_t hi )
+      {
+         return ( lo > hi ) ? byte_none() : ( utf8_class( lo, hi, 0, 0x7f ) | utf8_class( lo, hi, 0x80, 0x7ff ) | utf8_class( lo, hi, 0x800, 0xffff ) | utf8_class( lo, hi, 0x10000, 0x10ffff ) );
+      }
+
+   } // analysis
+
+} // pegtl
+
+#endif
@@ -0,0 +1,66 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_ANALYSIS_RULE_PROPERTIES_HH
+#define PEGTL_ANALYSIS_RULE_PROPERTIES_HH
+
+#include <bitset>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "rule_type.hh"
+
+namespace pegtl
+{
+   namespace analysis
+   {
+      enum class rule_kind : char
+      {
+         TERMINAL,   // Properties are known from the rule itself, e.g. one<>, string<> or eol.
+         PREDICATE,  // Never consumes input, e.g. at<>, not_at<> or eof.
+         SEQUENCE,   // Between repeat_min and repeat_max repetitions of the conjunction of sub-rules.
+         CHOICE,     // Ordered choice of the sub-rules.
+         LOOP,       // Like SEQUENCE, for star<> and plus<> with repeat_max == unbounded.
+         UNTIL       // until<>, the first sub-rule is the condition, the others the body.
+      };
+
+      struct rule_properties
+      {
+         static constexpr std::size_t unbounded = std::size_t( -1 );
+
+         explicit
+         rule_properties( const rule_type in_type )
+               : type( in_type )
+         { }
+
+         rule_type type;
+         rule_kind kind = rule_kind::SEQUENCE;
+         std::size_t repeat_min = 1;
+         std::size_t repeat_max = 1;
+         std::vector< std::string > rules;
+
+         bool negated = false;  // For PREDICATE, whether it is a not_at<>.
+         bool raises = false;  // For must<>, which raises an exception instead of failing.
+
+         // Whether the rule can succeed without consuming input, the minimum
+         // and maximum number of bytes consumed on success, and the set of
+         // bytes with which a successful match consuming input can start.
+         // Rules that can never succeed have min_length == unbounded.
+
+         bool nullable = false;
+         std::size_t min_length = unbounded;
+         std::size_t max_length = 0;
+         std::bitset< 256 > first;
+
+         bool can_succeed() const
+         {
+            return min_length != unbounded;
+         }
+      };
+
+   } // analysis
+
+} // pegtl
+
+#endif
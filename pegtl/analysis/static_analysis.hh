@@ -0,0 +1,556 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_ANALYSIS_STATIC_ANALYSIS_HH
+#define PEGTL_ANALYSIS_STATIC_ANALYSIS_HH
+
+#include <cstdint>
+#include <type_traits>
+
+#include "../internal/rules.hh"
+#include "../internal/bump_util.hh"
+#include "../internal/peek_char.hh"
+#include "../internal/peek_utf8.hh"
+
+#include "generic.hh"
+#include "byte_set.hh"
+
+namespace pegtl
+{
+   namespace analysis
+   {
+      // The compile-time analysis works on the analyze_t of the rules, just
+      // like analyze(), plus the first sets of the atomic rules. Instead of
+      // maps the rules of a grammar are collected in a type_list, then the
+      // nullability and the first sets are computed by fixpoint iteration
+      // over all rules, and cycles by a depth-first search.
+
+      template< typename ... Ts > struct type_list {};
+
+      template< typename T, typename List > struct list_contains;
+
+      template< typename T, typename ... Ts >
+      struct list_contains< T, type_list< Ts ... > >
+            : std::integral_constant< bool, ! internal::bool_and< ( ! std::is_same< T, Ts >::value ) ... >::value >
+      { };
+
+      template< typename T, typename List > struct list_push;
+
+      template< typename T, typename ... Ts >
+      struct list_push< T, type_list< Ts ... > >
+      {
+         using type = type_list< T, Ts ... >;
+      };
+
+      template< rule_type Type, typename ... Rules >
+      generic< Type, Rules ... > static_generic( const generic< Type, Rules ... > * );
+
+      template< typename Rule >
+      using static_analyze_t = decltype( static_generic( static_cast< const typename Rule::analyze_t * >( nullptr ) ) );
+
+      // All rules of a grammar, as type_list.
+
+      template< typename Seen, typename ... Rules >
+      struct static_collect
+      {
+         using type = Seen;
+      };
+
+      template< typename Seen, typename Analyze > struct static_collect_analyze;
+
+      template< typename Seen, rule_type Type, typename ... Rules >
+      struct static_collect_analyze< Seen, generic< Type, Rules ... > >
+            : static_collect< Seen, Rules ... >
+      { };
+
+      template< typename Seen, typename Rule, bool = list_contains< Rule, Seen >::value >
+      struct static_collect_rule
+      {
+         using type = Seen;
+      };
+
+      template< typename Seen, typename Rule >
+      struct static_collect_rule< Seen, Rule, false >
+            : static_collect_analyze< typename list_push< Rule, Seen >::type, static_analyze_t< Rule > >
+      { };
+
+      template< typename Seen, typename Rule, typename ... Rules >
+      struct static_collect< Seen, Rule, Rules ... >
+            : static_collect< typename static_collect_rule< Seen, Rule >::type, Rules ... >
+      { };
+
+      // The state of a fixpoint iteration over all rules of a grammar, the
+      // value for a rule is found via the conversion to the base class
+      // static_entry< Rule, Value >, i.e. without recursion.
+
+      template< typename T >
+      struct static_identity
+      {
+         using type = T;
+      };
+
+      template< typename Rule, typename Value > struct static_entry {};
+
+      template< typename ... Entries > struct static_state : Entries ... {};
+
+      template< typename Rule, typename Value >
+      Value static_lookup( const static_entry< Rule, Value > * );
+
+      template< typename Rule, typename State >
+      using static_value = decltype( static_lookup< Rule >( static_cast< const State * >( nullptr ) ) );
+
+      template< typename Step, typename List, typename State > struct static_fixpoint;
+
+      template< typename Step, typename ... Rules, typename State >
+      struct static_fixpoint< Step, type_list< Rules ... >, State >
+      {
+         using next = static_state< static_entry< Rules, typename Step::template step< Rules, State >::type > ... >;
+         using type = typename std::conditional< std::is_same< next, State >::value, static_identity< State >, static_fixpoint< Step, type_list< Rules ... >, next > >::type::type;
+      };
+
+      template< typename Step, typename List > struct static_solve;
+
+      template< typename Step, typename ... Rules >
+      struct static_solve< Step, type_list< Rules ... > >
+            : static_fixpoint< Step, type_list< Rules ... >, static_state< static_entry< Rules, typename Step::initial > ... > >
+      { };
+
+      // Whether a rule can succeed without consuming input, depending only
+      // on the rule_type of the analyze_t of the rules.
+
+      template< typename Analyze, typename State > struct static_nullable_step;
+
+      template< typename State, typename ... Rules >
+      struct static_nullable_step< generic< rule_type::ANY, Rules ... >, State >
+      {
+         using type = std::false_type;
+      };
+
+      template< typename State, typename ... Rules >
+      struct static_nullable_step< generic< rule_type::OPT, Rules ... >, State >
+      {
+         using type = std::true_type;
+      };
+
+      template< typename State, typename ... Rules >
+      struct static_nullable_step< generic< rule_type::SEQ, Rules ... >, State >
+      {
+         using type = std::integral_constant< bool, internal::bool_and< static_value< Rules, State >::value ... >::value >;
+      };
+
+      template< typename State, typename ... Rules >
+      struct static_nullable_step< generic< rule_type::SOR, Rules ... >, State >
+      {
+         using type = std::integral_constant< bool, ! internal::bool_and< ( ! static_value< Rules, State >::value ) ... >::value >;
+      };
+
+      struct static_nullable
+      {
+         using initial = std::false_type;
+
+         template< typename Rule, typename State >
+         using step = static_nullable_step< static_analyze_t< Rule >, State >;
+      };
+
+      // The first bytes of the atomic rules, computed from the characters
+      // and ranges for peek_char and peek_utf8; other Peek classes, like
+      // UTF-16 and UTF-32, can start with any byte. For peek_utf8 the
+      // complement of a set of code points is approximated by all valid
+      // UTF-8 lead bytes.
+
+      template< typename Peek >
+      struct static_peek_set
+      {
+         template< typename ... Ts >
+         static constexpr byte_set one( Ts ... )
+         {
+            return byte_all();
+         }
+
+         template< typename T >
+         static constexpr byte_set range( const T, const T )
+         {
+            return byte_all();
+         }
+
+         static constexpr byte_set complement( const byte_set )
+         {
+            return byte_all();
+         }
+      };
+
+      template<>
+      struct static_peek_set< internal::peek_char >
+      {
+         static constexpr byte_set one()
+         {
+            return byte_none();
+         }
+
+         template< typename ... Ts >
+         static constexpr byte_set one( const char c, Ts ... cs )
+         {
+            return byte_bit( ( unsigned char )( c ) ) | one( cs ... );
+         }
+
+         static constexpr byte_set range( const char lo, const char hi )
+         {
+            return char_range( lo, hi );
+         }
+
+         static constexpr byte_set complement( const byte_set s )
+         {
+            return ~s;
+         }
+      };
+
+      template<>
+      struct static_peek_set< internal::peek_utf8 >
+      {
+         static constexpr byte_set one()
+         {
+            return byte_none();
+         }
+
+         template< typename ... Ts >
+         static constexpr byte_set one( const char32_t c, Ts ... cs )
+         {
+            return utf8_range( c, c ) | one( cs ... );
+         }
+
+         static constexpr byte_set range( const char32_t lo, const char32_t hi )
+         {
+            return utf8_range( lo, ( hi < 0x10ffff ) ? hi : 0x10ffff );
+         }
+
+         static constexpr byte_set complement( const byte_set )
+         {
+            return utf8_range( 0, 0x10ffff );
+         }
+      };
+
+      template< typename Peek >
+      struct static_peek_ranges
+      {
+         static constexpr byte_set ranges()
+         {
+            return byte_none();
+         }
+
+         template< typename T >
+         static constexpr byte_set ranges( const T c )
+         {
+            return static_peek_set< Peek >::one( c );
+         }
+
+         template< typename T, typename ... Ts >
+         static constexpr byte_set ranges( const T lo, const T hi, Ts ... cs )
+         {
+            return static_peek_set< Peek >::range( lo, hi ) | ranges( cs ... );
+         }
+      };
+
+      template< internal::result_on_found R, typename Peek, typename Peek::data_t ... Cs >
+      struct static_one_first
+      {
+         static constexpr byte_set value()
+         {
+            return bool( R ) ? static_peek_set< Peek >::one( Cs ... ) : static_peek_set< Peek >::complement( static_peek_set< Peek >::one( Cs ... ) );
+         }
+      };
+
+      template< internal::result_on_found R, typename Peek, typename Peek::data_t Lo, typename Peek::data_t Hi >
+      struct static_range_first
+      {
+         static constexpr byte_set value()
+         {
+            return bool( R ) ? static_peek_set< Peek >::range( Lo, Hi ) : static_peek_set< Peek >::complement( static_peek_set< Peek >::range( Lo, Hi ) );
+         }
+      };
+
+      template< typename Peek, typename Peek::data_t ... Cs >
+      struct static_ranges_first
+      {
+         static constexpr byte_set value()
+         {
+            return static_peek_ranges< Peek >::ranges( Cs ... );
+         }
+      };
+
+      template< typename Peek >
+      struct static_any_first
+      {
+         static constexpr byte_set value()
+         {
+            return static_peek_set< Peek >::complement( byte_none() );
+         }
+      };
+
+      template< bool Case, char ... Cs >
+      struct static_string_first
+      {
+         static constexpr byte_set value()
+         {
+            return byte_none();
+         }
+      };
+
+      template< bool Case, char C, char ... Cs >
+      struct static_string_first< Case, C, Cs ... >
+      {
+         static constexpr byte_set value()
+         {
+            return byte_bit( ( unsigned char )( C ) ) | ( ( Case && ( ( C | 0x20 ) >= 'a' ) && ( ( C | 0x20 ) <= 'z' ) ) ? byte_bit( ( unsigned char )( C ^ 0x20 ) ) : byte_none() );
+         }
+      };
+
+      struct static_eol_first
+      {
+         static constexpr byte_set value()
+         {
+            return byte_bit( '\r' ) | byte_bit( '\n' );
+         }
+      };
+
+      struct static_no_first
+      {
+         static constexpr byte_set value()
+         {
+            return byte_none();
+         }
+      };
+
+      // Only declared, the return types of the overloads are used to find
+      // the first set of the atomic rules; rules that match none of these
+      // overloads are analysed via their analyze_t.
+
+      struct static_not_atomic;
+
+      static_not_atomic static_atomic_first( const void * );
+
+      template< internal::result_on_found R, typename Peek, typename Peek::data_t ... Cs >
+      static_one_first< R, Peek, Cs ... > static_atomic_first( const internal::one< R, Peek, Cs ... > * );
+
+      template< internal::result_on_found R, typename Peek, typename Peek::data_t Lo, typename Peek::data_t Hi >
+      static_range_first< R, Peek, Lo, Hi > static_atomic_first( const internal::range< R, Peek, Lo, Hi > * );
+
+      template< typename Peek, typename Peek::data_t ... Cs >
+      static_ranges_first< Peek, Cs ... > static_atomic_first( const internal::ranges< Peek, Cs ... > * );
+
+      template< typename Peek >
+      static_any_first< Peek > static_atomic_first( const internal::any< Peek > * );
+
+      template< char ... Cs >
+      static_string_first< false, Cs ... > static_atomic_first( const internal::string< Cs ... > * );
+
+      template< char ... Cs >
+      static_string_first< true, Cs ... > static_atomic_first( const internal::istring< Cs ... > * );
+
+      static_eol_first static_atomic_first( const internal::eol * );
+      static_eol_first static_atomic_first( const internal::eolf * );
+
+      template< typename T >
+      static_no_first static_atomic_first( const internal::raise< T > * );
+
+      template< bool Result >
+      static_no_first static_atomic_first( const internal::trivial< Result > * );
+
+      template< typename ... Rules >
+      static_no_first static_atomic_first( const internal::at< Rules ... > * );
+
+      template< typename ... Rules >
+      static_no_first static_atomic_first( const internal::not_at< Rules ... > * );
+
+      // The set of bytes with which a successful match of a rule that
+      // consumes input can start, a superset for rules with predicates.
+
+      template< std::uint64_t W0, std::uint64_t W1, std::uint64_t W2, std::uint64_t W3 >
+      struct static_bytes
+      {
+         static constexpr byte_set value()
+         {
+            return byte_set{ W0, W1, W2, W3 };
+         }
+      };
+
+      template< typename First >
+      using static_bytes_t = static_bytes< First::value().w0, First::value().w1, First::value().w2, First::value().w3 >;
+
+      template< typename State, typename ... Rules >
+      struct static_choice_first
+            : static_no_first
+      { };
+
+      template< typename State, typename Rule, typename ... Rules >
+      struct static_choice_first< State, Rule, Rules ... >
+      {
+         static constexpr byte_set value()
+         {
+            return static_value< Rule, State >::value() | static_choice_first< State, Rules ... >::value();
+         }
+      };
+
+      template< typename Nullable, typename State, typename ... Rules >
+      struct static_sequence_first
+            : static_no_first
+      { };
+
+      template< typename Nullable, typename State, typename Rule, typename ... Rules >
+      struct static_sequence_first< Nullable, State, Rule, Rules ... >
+      {
+         using next = typename std::conditional< static_value< Rule, Nullable >::value, static_sequence_first< Nullable, State, Rules ... >, static_no_first >::type;
+
+         static constexpr byte_set value()
+         {
+            return static_value< Rule, State >::value() | next::value();
+         }
+      };
+
+      template< typename Analyze, typename Nullable, typename State > struct static_structure_first;
+
+      template< rule_type Type, typename Nullable, typename State, typename ... Rules >
+      struct static_structure_first< generic< Type, Rules ... >, Nullable, State >
+            : static_sequence_first< Nullable, State, Rules ... >
+      { };
+
+      template< typename Nullable, typename State, typename ... Rules >
+      struct static_structure_first< generic< rule_type::SOR, Rules ... >, Nullable, State >
+            : static_choice_first< State, Rules ... >
+      { };
+
+      template< typename Nullable, typename State >
+      struct static_structure_first< generic< rule_type::ANY >, Nullable, State >
+      {
+         static constexpr byte_set value()
+         {
+            return byte_all();
+         }
+      };
+
+      template< typename Rule, typename Nullable, typename State, typename Atomic = decltype( static_atomic_first( static_cast< const Rule * >( nullptr ) ) ) >
+      struct static_first_step
+      {
+         using type = static_bytes_t< Atomic >;
+      };
+
+      template< typename Rule, typename Nullable, typename State >
+      struct static_first_step< Rule, Nullable, State, static_not_atomic >
+      {
+         using type = static_bytes_t< static_structure_first< static_analyze_t< Rule >, Nullable, State > >;
+      };
+
+      template< typename Nullable >
+      struct static_first
+      {
+         using initial = static_bytes< 0, 0, 0, 0 >;
+
+         template< typename Rule, typename State >
+         using step = static_first_step< Rule, Nullable, State >;
+      };
+
+      // Cycles without progress are cycles of rules where every rule is
+      // called by the next one before it consumed input, found with a
+      // depth-first search that threads the list of finished rules.
+
+      template< typename Nullable, typename ... Rules >
+      struct static_sequence_left
+      {
+         using type = type_list<>;
+      };
+
+      template< typename Nullable, typename Rule, typename ... Rules >
+      struct static_sequence_left< Nullable, Rule, Rules ... >
+      {
+         using type = typename list_push< Rule, typename std::conditional< static_value< Rule, Nullable >::value, static_sequence_left< Nullable, Rules ... >, static_identity< type_list<> > >::type::type >::type;
+      };
+
+      template< typename Analyze, typename Nullable > struct static_left;
+
+      template< rule_type Type, typename Nullable, typename ... Rules >
+      struct static_left< generic< Type, Rules ... >, Nullable >
+            : static_sequence_left< Nullable, Rules ... >
+      { };
+
+      template< typename Nullable, typename ... Rules >
+      struct static_left< generic< rule_type::SOR, Rules ... >, Nullable >
+      {
+         using type = type_list< Rules ... >;
+      };
+
+      template< bool Cycle, typename Done >
+      struct static_visited
+      {
+         static constexpr bool cycle = Cycle;
+         using done = Done;
+      };
+
+      template< typename Nullable, typename List, typename Stack, typename Done > struct static_visit_all;
+
+      template< typename Nullable, typename Rule, typename Stack, typename Done, bool = list_contains< Rule, Stack >::value, bool = list_contains< Rule, Done >::value >
+      struct static_visit
+            : static_visited< false, Done >
+      { };
+
+      template< typename Nullable, typename Rule, typename Stack, typename Done, bool Finished >
+      struct static_visit< Nullable, Rule, Stack, Done, true, Finished >
+            : static_visited< true, Done >
+      { };
+
+      template< typename Nullable, typename Rule, typename Stack, typename Done >
+      struct static_visit< Nullable, Rule, Stack, Done, false, false >
+      {
+         using visited = static_visit_all< Nullable, typename static_left< static_analyze_t< Rule >, Nullable >::type, typename list_push< Rule, Stack >::type, Done >;
+
+         static constexpr bool cycle = visited::cycle;
+         using done = typename list_push< Rule, typename visited::done >::type;
+      };
+
+      template< typename Nullable, typename Stack, typename Done >
+      struct static_visit_all< Nullable, type_list<>, Stack, Done >
+            : static_visited< false, Done >
+      { };
+
+      template< typename Nullable, typename Rule, typename ... Rules, typename Stack, typename Done >
+      struct static_visit_all< Nullable, type_list< Rule, Rules ... >, Stack, Done >
+      {
+         using visited = static_visit< Nullable, Rule, Stack, Done >;
+         using rest = typename std::conditional< visited::cycle, static_visited< true, typename visited::done >, static_visit_all< Nullable, type_list< Rules ... >, Stack, typename visited::done > >::type;
+
+         static constexpr bool cycle = rest::cycle;
+         using done = typename rest::done;
+      };
+
+      // The public interface, usable in constant expressions, e.g.
+      // static_assert( ! pegtl::analysis::has_cycles< grammar >::value, "..." ).
+
+      template< typename Rule >
+      struct grammar_rules
+            : static_collect< type_list<>, Rule >
+      { };
+
+      template< typename Rule >
+      struct is_nullable
+            : static_value< Rule, typename static_solve< static_nullable, typename grammar_rules< Rule >::type >::type >
+      { };
+
+      template< typename Rule >
+      struct has_cycles
+            : std::integral_constant< bool, static_visit_all< typename static_solve< static_nullable, typename grammar_rules< Rule >::type >::type, typename grammar_rules< Rule >::type, type_list<>, type_list<> >::cycle >
+      { };
+
+      template< typename Rule >
+      struct first_set
+      {
+         using nullable = typename static_solve< static_nullable, typename grammar_rules< Rule >::type >::type;
+
+         static constexpr byte_set value = static_value< Rule, typename static_solve< static_first< nullable >, typename grammar_rules< Rule >::type >::type >::value();
+      };
+
+      template< typename Rule >
+      constexpr byte_set first_set< Rule >::value;
+
+   } // analysis
+
+} // pegtl
+
+#endif
@@ -4,7 +4,11 @@
 #ifndef PEGTL_ANALYZE_HH
 #define PEGTL_ANALYZE_HH
 
+#include <ostream>
+
 #include "analysis/analyze_cycles.hh"
+#include "analysis/analyze_grammar.hh"
+#include "analysis/static_analysis.hh"
 
 namespace pegtl
 {
@@ -14,6 +18,17 @@ namespace pegtl
       return analysis::analyze_cycles< Rule >( verbose ).problems();
    }
 
+   // Writes the properties of all rules of the grammar, and the potential
+   // backtracking problems, as JSON; returns the number of such warnings.
+
+   template< typename Rule >
+   std::size_t analyze_report( std::ostream & o )
+   {
+      const analysis::analyze_grammar< Rule > a;
+      a.write_json( o );
+      return a.warnings().size();
+   }
+
 } // pegtl
 
 #endif
@@ -7,12 +7,29 @@
 #include <memory>
 #include <cstring>
 #include <cstddef>
+#include <algorithm>
 
 #include "internal/input_data.hh"
 #include "internal/input_mark.hh"
 
 namespace pegtl
 {
+   // Statistics about the use of the buffer of a buffer_input, e.g. to size
+   // the maximum of the buffer, or to detect grammars that do not discard
+   // (enough) data from the buffer. They are only updated when the reader is
+   // called or data is discarded, i.e. not on the fast path of the parsing.
+
+   struct buffer_stats
+   {
+      std::size_t maximum_buffered = 0;  // Largest amount of data in the buffer, including consumed but not discarded data.
+      std::size_t reader_calls = 0;  // Number of calls to the reader, including the final one that returned 0.
+      std::size_t requested_bytes = 0;  // Sum of the lengths passed to the reader.
+      std::size_t read_bytes = 0;  // Sum of the lengths returned by the reader.
+      std::size_t discards = 0;  // Number of calls to discard().
+      std::size_t moved_bytes = 0;  // Bytes moved to the beginning of the buffer by discard().
+      bool maximum_reached = false;  // Whether require() could not be fulfilled because the buffer was full.
+   };
+
    template< typename Reader >
    class buffer_input
    {
@@ -95,6 +112,8 @@ namespace pegtl
       void discard()
       {
          const auto s = m_data.end - m_data.begin;
+         ++m_stats.discards;
+         m_stats.moved_bytes += s;
          std::memmove( m_buffer.get(), m_data.begin, s );
          m_data.begin = m_buffer.get();
          m_data.end = m_buffer.get() + s;
@@ -104,16 +123,29 @@ namespace pegtl
       {
          if ( m_data.begin + amount > m_data.end ) {
             if ( m_data.begin + amount <= m_buffer.get() + m_maximum ) {
-               if ( const auto r = m_reader( const_cast< char * >( m_data.end ), amount - size_t( m_data.end - m_data.begin ) ) ) {
+               const auto length = amount - size_t( m_data.end - m_data.begin );
+               ++m_stats.reader_calls;
+               m_stats.requested_bytes += length;
+               if ( const auto r = m_reader( const_cast< char * >( m_data.end ), length ) ) {
                   m_data.end += r;
+                  m_stats.read_bytes += r;
+                  m_stats.maximum_buffered = std::max( m_stats.maximum_buffered, std::size_t( m_data.end - m_buffer.get() ) );
                }
                else {
                   m_maximum = 0;
                }
             }
+            else if ( m_maximum ) {
+               m_stats.maximum_reached = true;
+            }
          }
       }
 
+      const buffer_stats & stats() const
+      {
+         return m_stats;
+      }
+
       internal::input_mark mark()
       {
          return internal::input_mark( m_data );
@@ -124,6 +156,7 @@ namespace pegtl
       size_t m_maximum;
       std::unique_ptr< char[] > m_buffer;
       internal::input_data m_data;
+      buffer_stats m_stats;
    };
 
 } // pegtl
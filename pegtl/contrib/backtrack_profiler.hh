@@ -0,0 +1,178 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_BACKTRACK_PROFILER_HH
+#define PEGTL_CONTRIB_BACKTRACK_PROFILER_HH
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <algorithm>
+
+#include "../normal.hh"
+#include "../apply_mode.hh"
+
+#include "rule_id.hh"
+#include "per_thread.hh"
+
+namespace pegtl
+{
+   struct backtrack_entry
+   {
+      std::size_t failure = 0;
+      std::size_t wasted_failure = 0;  // Failures after consuming input.
+      std::uint64_t wasted = 0;  // Total bytes consumed before failures.
+      std::size_t maximum = 0;  // Most bytes consumed before a single failure.
+   };
+
+   // The data collected by the backtrack_profiler for the current thread:
+   // per rule, indexed by internal::rule_id< Rule >, the bytes that were
+   // consumed by sub-rules of a failed match attempt, i.e. the bytes that
+   // will have to be scanned again after backtracking. When a base address
+   // was set with reset(), also a heatmap that counts the match attempts
+   // that started in each region of the input, with offsets relative to
+   // the base address, which only makes sense for memory inputs.
+
+   class backtrack_profile
+   {
+   public:
+      static std::vector< backtrack_entry > & entries()
+      {
+         return data().entries;
+      }
+
+      static backtrack_entry & entry( const std::size_t id )
+      {
+         auto & e = entries();
+         if ( id >= e.size() ) {
+            e.resize( internal::rule_registry::size() );
+         }
+         return e[ id ];
+      }
+
+      static const std::vector< std::size_t > & heatmap()
+      {
+         return data().heatmap;
+      }
+
+      static std::size_t region()
+      {
+         return data().region;
+      }
+
+      static void reset( const char * base = nullptr, const std::size_t region = 64 )
+      {
+         auto & d = data();
+         d.entries.assign( d.entries.size(), backtrack_entry() );
+         d.heatmap.clear();
+         d.base = base;
+         d.region = std::max( region, std::size_t( 1 ) );
+         d.furthest = nullptr;
+      }
+
+      // Prints one line for every rule with a failure after consuming
+      // input, sorted by the total number of bytes wasted.
+
+      static void report( std::ostream & o )
+      {
+         const auto & e = entries();
+         std::vector< std::size_t > ids;
+         for ( std::size_t i = 0; i < e.size(); ++i ) {
+            if ( e[ i ].wasted ) {
+               ids.push_back( i );
+            }
+         }
+         std::stable_sort( ids.begin(), ids.end(), [ & ]( const std::size_t l, const std::size_t r ){ return e[ l ].wasted > e[ r ].wasted; } );
+
+         o << std::setw( 12 ) << "failure" << std::setw( 12 ) << "wasted" << std::setw( 14 ) << "bytes" << std::setw( 12 ) << "maximum" << "  rule\n";
+         for ( const auto i : ids ) {
+            const auto & b = e[ i ];
+            o << std::setw( 12 ) << b.failure << std::setw( 12 ) << b.wasted_failure << std::setw( 14 ) << b.wasted << std::setw( 12 ) << b.maximum << "  " << internal::rule_registry::name( i ) << '\n';
+         }
+      }
+
+      // Prints the count regions of the heatmap with the most match attempts.
+
+      static void report_heatmap( std::ostream & o, const std::size_t count = 20 )
+      {
+         const auto & h = heatmap();
+         std::vector< std::size_t > regions;
+         for ( std::size_t i = 0; i < h.size(); ++i ) {
+            if ( h[ i ] ) {
+               regions.push_back( i );
+            }
+         }
+         std::stable_sort( regions.begin(), regions.end(), [ & ]( const std::size_t l, const std::size_t r ){ return h[ l ] > h[ r ]; } );
+         regions.resize( std::min( regions.size(), count ) );
+
+         o << std::setw( 14 ) << "offset" << std::setw( 14 ) << "attempts" << '\n';
+         for ( const auto i : regions ) {
+            o << std::setw( 14 ) << i * region() << std::setw( 14 ) << h[ i ] << '\n';
+         }
+      }
+
+   private:
+      template< typename > friend struct backtrack_profiler;
+
+      struct state
+      {
+         std::vector< backtrack_entry > entries = std::vector< backtrack_entry >( internal::rule_registry::size() );
+         std::vector< std::size_t > heatmap;
+         const char * base = nullptr;
+         std::size_t region = 64;
+         const char * furthest = nullptr;  // Furthest position reached in the current match attempt.
+      };
+
+      static state & data()
+      {
+         return internal::per_thread< state >();
+      }
+   };
+
+   // Control class that collects the data for the backtrack_profile.
+
+   template< typename Rule >
+   struct backtrack_profiler
+         : normal< Rule >
+   {
+      template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static bool match( Input & in, States && ... st )
+      {
+         auto & d = backtrack_profile::data();
+         const char * begin = in.begin();
+
+         if ( d.base && ( begin >= d.base ) ) {
+            const std::size_t i = std::size_t( begin - d.base ) / d.region;
+            if ( i >= d.heatmap.size() ) {
+               d.heatmap.resize( i + 1 );
+            }
+            ++d.heatmap[ i ];
+         }
+         const char * outer = d.furthest;
+         d.furthest = begin;
+
+         const bool result = normal< Rule >::template match< A, Action, Control >( in, st ... );
+
+         if ( result ) {
+            d.furthest = std::max( d.furthest, in.begin() );
+         }
+         else {
+            auto & e = backtrack_profile::entry( internal::rule_id< Rule >::value );
+            ++e.failure;
+            if ( d.furthest > begin ) {
+               const std::size_t w = d.furthest - begin;
+               ++e.wasted_failure;
+               e.wasted += w;
+               e.maximum = std::max( e.maximum, w );
+            }
+         }
+         d.furthest = outer ? std::max( outer, d.furthest ) : d.furthest;
+         return result;
+      }
+   };
+
+} // pegtl
+
+#endif
@@ -0,0 +1,221 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_BINARY_TRACE_HH
+#define PEGTL_CONTRIB_BINARY_TRACE_HH
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+#include "../normal.hh"
+#include "../input_error.hh"
+
+#include "rule_id.hh"
+#include "per_thread.hh"
+
+namespace pegtl
+{
+   enum class trace_event : std::uint8_t
+   {
+      START,
+      SUCCESS,
+      FAILURE,
+      RAISE
+   };
+
+   struct trace_record
+   {
+      std::uint32_t rule;
+      trace_event event;
+      std::uint32_t line;
+      std::uint32_t byte_in_line;
+   };
+
+   // Per-thread ring buffer of fixed-size trace records that keeps the most
+   // recent events; the records are only converted into a portable binary
+   // format, together with the names of the rules, when the trace is written.
+   // The format is "PEGTLTRC", the number of rules, the rule names, each as
+   // length and characters, the number of records, and the records, each as
+   // rule id, event, line and byte in line. All numbers are 32-bit little
+   // endian, except for the event which is a single byte.
+
+   class binary_trace
+   {
+   public:
+      static void reset( const std::size_t capacity = 1 << 16 )
+      {
+         auto & d = data();
+         std::size_t c = 1;
+         while ( c < capacity ) {
+            c <<= 1;
+         }
+         d.ring.assign( c, trace_record() );
+         d.count = 0;
+      }
+
+      static void record( const std::size_t rule, const trace_event event, const std::size_t line, const std::size_t byte_in_line )
+      {
+         auto & d = data();
+         d.ring[ d.count++ & ( d.ring.size() - 1 ) ] = trace_record{ std::uint32_t( rule ), event, std::uint32_t( line ), std::uint32_t( byte_in_line ) };
+      }
+
+      // The retained records, oldest first.
+
+      static std::vector< trace_record > records()
+      {
+         const auto & d = data();
+         const std::size_t size = d.ring.size();
+         std::vector< trace_record > result;
+         for ( std::uint64_t i = ( d.count > size ) ? ( d.count - size ) : 0; i < d.count; ++i ) {
+            result.push_back( d.ring[ i & ( size - 1 ) ] );
+         }
+         return result;
+      }
+
+      static void write( std::ostream & o )
+      {
+         o.write( "PEGTLTRC", 8 );
+         const std::size_t rules = internal::rule_registry::size();
+         write_number( o, rules );
+         for ( std::size_t i = 0; i < rules; ++i ) {
+            const std::string name = internal::rule_registry::name( i );
+            write_number( o, name.size() );
+            o.write( name.data(), name.size() );
+         }
+         const auto r = records();
+         write_number( o, r.size() );
+         for ( const auto & t : r ) {
+            write_number( o, t.rule );
+            o.put( char( t.event ) );
+            write_number( o, t.line );
+            write_number( o, t.byte_in_line );
+         }
+      }
+
+      static void write( const std::string & filename )
+      {
+         std::ofstream o( filename, std::ios::binary );
+         write( o );
+         if ( ! o ) {
+            PEGTL_THROW_INPUT_ERROR( "unable to write trace to file " << filename );
+         }
+      }
+
+      // Reads a trace that was written by write(), returns false when the data is not a valid trace.
+
+      static bool read( std::istream & i, std::vector< std::string > & names, std::vector< trace_record > & records )
+      {
+         char magic[ 8 ];
+         if ( ( ! i.read( magic, 8 ) ) || ( std::string( magic, 8 ) != "PEGTLTRC" ) ) {
+            return false;
+         }
+         std::uint32_t count;
+         if ( ! read_number( i, count ) ) {
+            return false;
+         }
+         names.clear();
+         for ( std::uint32_t n = 0; n < count; ++n ) {
+            std::uint32_t size;
+            if ( ! read_number( i, size ) ) {
+               return false;
+            }
+            std::string name( size, '\0' );
+            if ( size && ( ! i.read( & name[ 0 ], size ) ) ) {
+               return false;
+            }
+            names.push_back( std::move( name ) );
+         }
+         if ( ! read_number( i, count ) ) {
+            return false;
+         }
+         records.clear();
+         for ( std::uint32_t n = 0; n < count; ++n ) {
+            trace_record t;
+            if ( ! read_number( i, t.rule ) ) {
+               return false;
+            }
+            const int e = i.get();
+            if ( ( e < 0 ) || ( e > int( trace_event::RAISE ) ) ) {
+               return false;
+            }
+            t.event = trace_event( e );
+            if ( ( ! read_number( i, t.line ) ) || ( ! read_number( i, t.byte_in_line ) ) || ( t.rule >= names.size() ) ) {
+               return false;
+            }
+            records.push_back( t );
+         }
+         return true;
+      }
+
+   private:
+      struct state
+      {
+         std::vector< trace_record > ring = std::vector< trace_record >( 1 << 16 );
+         std::uint64_t count = 0;
+      };
+
+      static state & data()
+      {
+         return internal::per_thread< state >();
+      }
+
+      static void write_number( std::ostream & o, const std::size_t value )
+      {
+         for ( unsigned i = 0; i < 4; ++i ) {
+            o.put( char( ( value >> ( 8 * i ) ) & 0xff ) );
+         }
+      }
+
+      static bool read_number( std::istream & i, std::uint32_t & value )
+      {
+         unsigned char b[ 4 ];
+         if ( ! i.read( reinterpret_cast< char * >( b ), 4 ) ) {
+            return false;
+         }
+         value = std::uint32_t( b[ 0 ] ) | ( std::uint32_t( b[ 1 ] ) << 8 ) | ( std::uint32_t( b[ 2 ] ) << 16 ) | ( std::uint32_t( b[ 3 ] ) << 24 );
+         return true;
+      }
+   };
+
+   // Control class that records start, success, failure and raise events
+   // into the binary_trace of the current thread; cheap enough to be left
+   // enabled, e.g. to write the last events after a parsing error.
+
+   template< typename Rule >
+   struct binary_tracer
+         : normal< Rule >
+   {
+      template< typename Input, typename ... States >
+      static void start( const Input & in, States && ... )
+      {
+         binary_trace::record( internal::rule_id< Rule >::value, trace_event::START, in.line(), in.byte_in_line() );
+      }
+
+      template< typename Input, typename ... States >
+      static void success( const Input & in, States && ... )
+      {
+         binary_trace::record( internal::rule_id< Rule >::value, trace_event::SUCCESS, in.line(), in.byte_in_line() );
+      }
+
+      template< typename Input, typename ... States >
+      static void failure( const Input & in, States && ... )
+      {
+         binary_trace::record( internal::rule_id< Rule >::value, trace_event::FAILURE, in.line(), in.byte_in_line() );
+      }
+
+      template< typename Input, typename ... States >
+      static void raise( const Input & in, States && ... st )
+      {
+         binary_trace::record( internal::rule_id< Rule >::value, trace_event::RAISE, in.line(), in.byte_in_line() );
+         normal< Rule >::raise( in, st ... );
+      }
+   };
+
+} // pegtl
+
+#endif
@@ -0,0 +1,201 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_CALL_TREE_HH
+#define PEGTL_CONTRIB_CALL_TREE_HH
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+#include "../normal.hh"
+#include "../apply_mode.hh"
+
+#include "rule_id.hh"
+#include "per_thread.hh"
+
+namespace pegtl
+{
+   struct call_tree_node
+   {
+      std::size_t rule;  // The rule id, unused for the root.
+      std::size_t parent;
+      std::vector< std::size_t > children;
+      std::size_t count = 0;
+      std::size_t success = 0;
+      std::uint64_t bytes = 0;  // Consumed by successful matches.
+      std::uint64_t inclusive = 0;  // Nanoseconds including the children.
+      std::uint64_t exclusive = 0;  // Nanoseconds excluding the children.
+
+      call_tree_node( const std::size_t in_rule, const std::size_t in_parent )
+            : rule( in_rule ),
+              parent( in_parent )
+      { }
+   };
+
+   // The call tree collected by the call_tree_profiler for the current thread,
+   // i.e. the data for every distinct stack of rules that was encountered.
+   // Node 0 is an artificial root node, the other nodes are identified by
+   // the path from the root.
+
+   class call_tree
+   {
+   public:
+      enum class metric
+      {
+         EXCLUSIVE,  // Nanoseconds, the usual choice for flame graphs.
+         INCLUSIVE,
+         COUNT,
+         BYTES
+      };
+
+      static const std::vector< call_tree_node > & nodes()
+      {
+         return data().nodes;
+      }
+
+      static void reset()
+      {
+         auto & d = data();
+         d.nodes.assign( 1, call_tree_node( 0, 0 ) );
+         d.current = 0;
+      }
+
+      // Writes the folded-stack format used by flame graph tools, one line
+      // with the rule names separated by semicolons and the chosen metric
+      // for every node with a non-zero value.
+
+      static void write_folded( std::ostream & o, const metric m = metric::EXCLUSIVE )
+      {
+         std::vector< std::string > names( internal::rule_registry::size() );
+         std::string stack;
+         write_folded( o, m, names, 0, stack );
+      }
+
+   private:
+      template< typename > friend struct call_tree_profiler;
+
+      struct state
+      {
+         std::vector< call_tree_node > nodes = std::vector< call_tree_node >( 1, call_tree_node( 0, 0 ) );
+         std::size_t current = 0;
+
+         std::size_t enter( const std::size_t rule )
+         {
+            for ( const auto c : nodes[ current ].children ) {
+               if ( nodes[ c ].rule == rule ) {
+                  return current = c;
+               }
+            }
+            nodes.emplace_back( rule, current );
+            nodes[ current ].children.push_back( nodes.size() - 1 );
+            return current = nodes.size() - 1;
+         }
+      };
+
+      static state & data()
+      {
+         return internal::per_thread< state >();
+      }
+
+      static std::uint64_t value( const call_tree_node & n, const metric m )
+      {
+         switch ( m ) {
+            case metric::EXCLUSIVE:
+               return n.exclusive;
+            case metric::INCLUSIVE:
+               return n.inclusive;
+            case metric::COUNT:
+               return n.count;
+            case metric::BYTES:
+               return n.bytes;
+         }
+         return 0;  // LCOV_EXCL_LINE
+      }
+
+      static void write_folded( std::ostream & o, const metric m, std::vector< std::string > & names, const std::size_t node, std::string & stack )
+      {
+         const auto & n = nodes()[ node ];
+         const std::size_t size = stack.size();
+         if ( node ) {
+            auto & name = names[ n.rule ];
+            if ( name.empty() ) {
+               name = internal::rule_registry::name( n.rule );
+            }
+            stack += ( size ? ";" : "" ) + name;
+            if ( const auto v = value( n, m ) ) {
+               o << stack << ' ' << v << '\n';
+            }
+         }
+         for ( const auto c : n.children ) {
+            write_folded( o, m, names, c, stack );
+         }
+         stack.resize( size );
+      }
+   };
+
+   // Control class that maintains the stack of active rules and collects the
+   // number of match attempts, successes, consumed bytes, and the inclusive
+   // and exclusive time for every distinct stack in the call_tree.
+
+   template< typename Rule >
+   struct call_tree_profiler
+         : normal< Rule >
+   {
+      template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static bool match( Input & in, States && ... st )
+      {
+         guard g( in.begin() );
+         g.result = normal< Rule >::template match< A, Action, Control >( in, st ... );
+         g.end = in.begin();
+         return g.result;
+      }
+
+   private:
+      // Also leaves the node when the match is aborted by an exception.
+
+      struct guard
+      {
+         explicit
+         guard( const char * in_begin )
+               : node( call_tree::data().enter( internal::rule_id< Rule >::value ) ),
+                 begin( in_begin ),
+                 time( std::chrono::steady_clock::now() )
+         { }
+
+         ~guard()
+         {
+            const std::uint64_t t = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - time ).count();
+            auto & d = call_tree::data();
+            auto & n = d.nodes[ node ];
+            ++n.count;
+            n.inclusive += t;
+            n.exclusive += t;
+            if ( result ) {
+               ++n.success;
+               n.bytes += end - begin;
+            }
+            d.current = n.parent;
+            if ( d.current ) {
+               // Wraps around temporarily, the parent adds its (larger) time when it is left.
+               d.nodes[ d.current ].exclusive -= t;
+            }
+         }
+
+         guard( const guard & ) = delete;
+         void operator= ( const guard & ) = delete;
+
+         const std::size_t node;
+         const char * const begin;
+         const std::chrono::steady_clock::time_point time;
+         bool result = false;
+         const char * end = nullptr;
+      };
+   };
+
+} // pegtl
+
+#endif
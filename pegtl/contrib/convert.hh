@@ -0,0 +1,599 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_CONVERT_HH
+#define PEGTL_CONTRIB_CONVERT_HH
+
+#include <cmath>
+#include <limits>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "../parse_error.hh"
+
+#include "../internal/swar.hh"
+
+#include "powers_of_ten.hh"
+
+namespace pegtl
+{
+   namespace convert
+   {
+      // Utility functions for the convert actions; they all expect input
+      // that was already matched by a suitable grammar rule, see the
+      // comments of the individual functions for details.
+
+      inline bool is_eight_digits( const std::uint64_t v )
+      {
+         return ( ( v & 0xf0f0f0f0f0f0f0f0 ) | ( ( ( v + 0x0606060606060606 ) & 0xf0f0f0f0f0f0f0f0 ) >> 4 ) ) == 0x3333333333333333;
+      }
+
+      // Converts eight ASCII digits, first digit in the lowest byte, with
+      // three multiplications instead of eight.
+
+      inline std::uint32_t convert_eight_digits( std::uint64_t v )
+      {
+         v -= 0x3030303030303030;
+         v = ( v * 10 ) + ( v >> 8 );
+         v = ( ( ( v & 0x000000ff000000ff ) * ( 100 + ( 1000000ull << 32 ) ) ) + ( ( ( v >> 16 ) & 0x000000ff000000ff ) * ( 1 + ( 10000ull << 32 ) ) ) ) >> 32;
+         return std::uint32_t( v );
+      }
+
+      // Accumulates the decimal digits in [begin, end) into result,
+      // returns false on a non-digit character or when the value is
+      // larger than limit.
+
+      inline bool accumulate_digits( const char * begin, const char * const end, const std::uint64_t limit, std::uint64_t & result )
+      {
+         std::uint64_t r = 0;
+
+         while ( end - begin >= 8 ) {
+            const auto v = internal::swar_load( begin );
+            if ( ! is_eight_digits( v ) ) {
+               break;
+            }
+            const auto d = convert_eight_digits( v );
+            if ( ( r > limit / 100000000 ) || ( limit - r * 100000000 < d ) ) {
+               return false;
+            }
+            r = r * 100000000 + d;
+            begin += 8;
+         }
+         for ( ; begin != end; ++begin ) {
+            const unsigned d = unsigned( * begin ) - '0';
+            if ( d > 9 ) {
+               return false;
+            }
+            if ( ( r > limit / 10 ) || ( limit - r * 10 < d ) ) {
+               return false;
+            }
+            r = r * 10 + d;
+         }
+         result = r;
+         return true;
+      }
+
+      // Converts an optional sign followed by decimal digits into an
+      // integer of type I, returns false when the value is out of range.
+
+      template< typename I >
+      bool to_integer( const char * begin, const char * const end, I & result )
+      {
+         static_assert( std::is_integral< I >::value, "to_integer() requires an integral type" );
+         static_assert( sizeof( I ) <= sizeof( std::uint64_t ), "to_integer() requires an integral type of at most 64 bits" );
+
+         const bool negative = ( begin != end ) && ( * begin == '-' );
+         if ( ( begin != end ) && ( ( * begin == '-' ) || ( * begin == '+' ) ) ) {
+            ++begin;
+         }
+         if ( begin == end ) {
+            return false;
+         }
+         const std::uint64_t limit = std::uint64_t( std::numeric_limits< I >::max() ) + ( negative && std::is_signed< I >::value );
+         std::uint64_t r;
+         if ( ! accumulate_digits( begin, end, negative ? ( std::is_signed< I >::value ? limit : 0 ) : limit, r ) ) {
+            return false;
+         }
+         // A negative value is formed from r - 1, which is always in range for I, so
+         // that there is no conversion of an out-of-range value to a signed type.
+         result = ( negative && r ) ? I( -I( r - 1 ) - 1 ) : I( r );
+         return true;
+      }
+
+      // Slow path for to_double(): the number is stored as (up to) 800
+      // decimal digits, which is enough for an exact representation of
+      // every halfway point between two doubles, and repeatedly shifted by
+      // powers of two until the significand can be read with the correct
+      // rounding; more digits are only remembered as being non-zero. This
+      // is the "simple decimal conversion" as used by Go's strconv, and
+      // neither allocates memory nor depends on the locale.
+
+      class big_decimal
+      {
+      public:
+         // Expects the same syntax as to_double().
+
+         big_decimal( const char * begin, const char * const end )
+         {
+            m_negative = ( begin != end ) && ( * begin == '-' );
+            if ( ( begin != end ) && ( ( * begin == '-' ) || ( * begin == '+' ) ) ) {
+               ++begin;
+            }
+            bool point = false;
+            for ( ; begin != end; ++begin ) {
+               const char c = * begin;
+               if ( ( c == '.' ) && ! point ) {
+                  point = true;
+                  m_point = m_count;
+               }
+               else if ( unsigned( c ) - '0' <= 9 ) {
+                  if ( ( c == '0' ) && ( m_count == 0 ) ) {
+                     --m_point;  // Leading zeros.
+                  }
+                  else if ( m_count < max_digits ) {
+                     m_digits[ m_count++ ] = c;
+                  }
+                  else if ( c != '0' ) {
+                     m_truncated = true;
+                  }
+               }
+               else {
+                  break;
+               }
+            }
+            if ( ! point ) {
+               m_point = m_count;
+            }
+            if ( ( begin != end ) && ( ( * begin == 'e' ) || ( * begin == 'E' ) ) ) {
+               ++begin;
+               const bool minus = ( begin != end ) && ( * begin == '-' );
+               if ( ( begin != end ) && ( ( * begin == '-' ) || ( * begin == '+' ) ) ) {
+                  ++begin;
+               }
+               int e = 0;
+               for ( ; ( begin != end ) && ( unsigned( * begin ) - '0' <= 9 ); ++begin ) {
+                  if ( e < 10000 ) {
+                     e = e * 10 + ( * begin - '0' );
+                  }
+               }
+               m_point += minus ? -e : e;
+            }
+            trim();
+         }
+
+         // Returns the correctly rounded double, infinity on overflow.
+
+         double to_double()
+         {
+            static const int steps[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };  // Shifts that keep the first digit non-zero.
+            const int bias = -1023;
+            std::uint64_t mantissa = 0;
+            int exponent = bias;
+
+            if ( m_count == 0 ) {
+               return assemble( 0, bias );
+            }
+            if ( m_point > 310 ) {
+               return assemble( 0, 0x7ff + bias );
+            }
+            if ( m_point < -330 ) {
+               return assemble( 0, bias );
+            }
+            // Scale to [ 0.5, 1 ).
+            exponent = 0;
+            while ( m_point > 0 ) {
+               const int n = ( m_point >= 9 ) ? 27 : steps[ m_point ];
+               shift( -n );
+               exponent += n;
+            }
+            while ( ( m_point < 0 ) || ( ( m_point == 0 ) && ( m_digits[ 0 ] < '5' ) ) ) {
+               const int n = ( -m_point >= 9 ) ? 27 : steps[ -m_point ];
+               shift( n );
+               exponent -= n;
+            }
+            --exponent;  // The range of the significand of a double is [ 1, 2 ).
+
+            if ( exponent < bias + 1 ) {
+               const int n = bias + 1 - exponent;  // Subnormal.
+               shift( -n );
+               exponent += n;
+            }
+            if ( exponent - bias >= 0x7ff ) {
+               return assemble( 0, 0x7ff + bias );
+            }
+            shift( 53 );
+            mantissa = rounded_integer();
+
+            if ( mantissa == ( std::uint64_t( 2 ) << 52 ) ) {
+               mantissa >>= 1;  // Rounding carried into a new bit.
+               if ( ++exponent - bias >= 0x7ff ) {
+                  return assemble( 0, 0x7ff + bias );
+               }
+            }
+            if ( ! ( mantissa & ( std::uint64_t( 1 ) << 52 ) ) ) {
+               exponent = bias;
+            }
+            return assemble( mantissa, exponent );
+         }
+
+      private:
+         static const int max_digits = 800;
+         static const int max_shift = 27;  // 5^27 still fits into 64 bits.
+
+         char m_digits[ max_digits ];  // As characters '0' to '9', without leading or trailing zeros.
+         int m_count = 0;
+         int m_point = 0;  // Position of the decimal point relative to the first digit.
+         bool m_negative = false;
+         bool m_truncated = false;
+
+         double assemble( const std::uint64_t mantissa, const int exponent ) const
+         {
+            std::uint64_t bits = mantissa & ( ( std::uint64_t( 1 ) << 52 ) - 1 );
+            bits |= std::uint64_t( ( exponent + 1023 ) & 0x7ff ) << 52;
+            bits |= std::uint64_t( m_negative ) << 63;
+            double d;
+            std::memcpy( & d, & bits, sizeof( d ) );
+            return d;
+         }
+
+         void trim()
+         {
+            while ( ( m_count > 0 ) && ( m_digits[ m_count - 1 ] == '0' ) ) {
+               --m_count;
+            }
+            if ( m_count == 0 ) {
+               m_point = 0;
+            }
+         }
+
+         void shift( int k )
+         {
+            if ( m_count == 0 ) {
+               return;
+            }
+            for ( ; k > max_shift; k -= max_shift ) {
+               left_shift( max_shift );
+            }
+            for ( ; k < -max_shift; k += max_shift ) {
+               right_shift( max_shift );
+            }
+            if ( k > 0 ) {
+               left_shift( unsigned( k ) );
+            }
+            else if ( k < 0 ) {
+               right_shift( unsigned( -k ) );
+            }
+         }
+
+         // Multiplies by 2^k, for k <= max_shift; the number of new digits
+         // is that of 2^k, or one less when the digits are less than 5^k.
+
+         void left_shift( const unsigned k )
+         {
+            char cutoff[ 20 ];
+            int length = 0;
+            for ( std::uint64_t p = power( 5, k ); p; p /= 10 ) {
+               cutoff[ length++ ] = char( '0' + p % 10 );
+            }
+            int delta = 0;
+            for ( std::uint64_t p = std::uint64_t( 1 ) << k; p; p /= 10 ) {
+               ++delta;
+            }
+            for ( int i = 0; i < length; ++i ) {
+               const char c = cutoff[ length - 1 - i ];
+               if ( ( i >= m_count ) || ( m_digits[ i ] != c ) ) {
+                  delta -= ( i >= m_count ) || ( m_digits[ i ] < c );
+                  break;
+               }
+            }
+            int w = m_count + delta;
+            std::uint64_t n = 0;
+            for ( int r = m_count - 1; r >= 0; --r ) {
+               n += std::uint64_t( m_digits[ r ] - '0' ) << k;
+               put( --w, n );
+               n /= 10;
+            }
+            for ( ; n > 0; n /= 10 ) {
+               put( --w, n );
+            }
+            m_count = ( m_count + delta < max_digits ) ? ( m_count + delta ) : max_digits;
+            m_point += delta;
+            trim();
+         }
+
+         void put( const int w, const std::uint64_t n )
+         {
+            const char d = char( n % 10 );
+            if ( w < max_digits ) {
+               m_digits[ w ] = char( '0' + d );
+            }
+            else if ( d != 0 ) {
+               m_truncated = true;
+            }
+         }
+
+         // Divides by 2^k, for k <= max_shift.
+
+         void right_shift( const unsigned k )
+         {
+            int r = 0;
+            int w = 0;
+            std::uint64_t n = 0;
+            for ( ; ( n >> k ) == 0; ++r ) {
+               if ( r >= m_count ) {
+                  for ( ; ( n >> k ) == 0; ++r ) {
+                     n *= 10;
+                  }
+                  break;
+               }
+               n = n * 10 + unsigned( m_digits[ r ] - '0' );
+            }
+            m_point -= r - 1;
+            const std::uint64_t mask = ( std::uint64_t( 1 ) << k ) - 1;
+            for ( ; r < m_count; ++r ) {
+               const std::uint64_t d = n >> k;
+               n &= mask;
+               m_digits[ w++ ] = char( '0' + d );
+               n = n * 10 + unsigned( m_digits[ r ] - '0' );
+            }
+            for ( ; n > 0; n *= 10 ) {
+               const std::uint64_t d = n >> k;
+               n &= mask;
+               if ( w < max_digits ) {
+                  m_digits[ w++ ] = char( '0' + d );
+               }
+               else if ( d > 0 ) {
+                  m_truncated = true;
+               }
+            }
+            m_count = w;
+            trim();
+         }
+
+         // The integer part, rounded half to even; the truncated digits
+         // are always greater than zero.
+
+         std::uint64_t rounded_integer() const
+         {
+            std::uint64_t n = 0;
+            int i = 0;
+            for ( ; ( i < m_point ) && ( i < m_count ); ++i ) {
+               n = n * 10 + unsigned( m_digits[ i ] - '0' );
+            }
+            for ( ; i < m_point; ++i ) {
+               n *= 10;
+            }
+            if ( ( m_point >= 0 ) && ( m_point < m_count ) ) {
+               if ( ( m_digits[ m_point ] == '5' ) && ( m_point + 1 == m_count ) ) {
+                  n += m_truncated || ( ( m_point > 0 ) && ( ( m_digits[ m_point - 1 ] - '0' ) % 2 == 1 ) );
+               }
+               else {
+                  n += ( m_digits[ m_point ] >= '5' );
+               }
+            }
+            return n;
+         }
+
+         static std::uint64_t power( const std::uint64_t b, unsigned e )
+         {
+            std::uint64_t r = 1;
+            while ( e-- ) {
+               r *= b;
+            }
+            return r;
+         }
+      };
+
+      // The full 128-bit product of two 64-bit integers.
+
+      inline void multiply( const std::uint64_t a, const std::uint64_t b, std::uint64_t & high, std::uint64_t & low )
+      {
+#if defined( __SIZEOF_INT128__ )
+         __extension__ typedef unsigned __int128 uint128;
+         const uint128 r = uint128( a ) * b;
+         high = std::uint64_t( r >> 64 );
+         low = std::uint64_t( r );
+#else
+         const std::uint64_t a0 = a & 0xffffffff;
+         const std::uint64_t a1 = a >> 32;
+         const std::uint64_t b0 = b & 0xffffffff;
+         const std::uint64_t b1 = b >> 32;
+         const std::uint64_t p01 = a0 * b1;
+         const std::uint64_t p10 = a1 * b0;
+         const std::uint64_t mid = ( ( a0 * b0 ) >> 32 ) + ( p01 & 0xffffffff ) + ( p10 & 0xffffffff );
+         low = ( mid << 32 ) | ( ( a0 * b0 ) & 0xffffffff );
+         high = a1 * b1 + ( p01 >> 32 ) + ( p10 >> 32 ) + ( mid >> 32 );
+#endif
+      }
+
+      // For v != 0.
+
+      inline int leading_zeros( std::uint64_t v )
+      {
+         int n = 0;
+         for ( int s = 32; s; s >>= 1 ) {
+            if ( ! ( v >> ( 64 - s ) ) ) {
+               v <<= s;
+               n += s;
+            }
+         }
+         return n;
+      }
+
+      // The Eisel-Lemire algorithm computes m * 10^q, for m != 0, from the
+      // product of m with the truncated 128-bit approximation of 10^q, and
+      // returns false when the error of the approximation could change the
+      // rounding, or when the result is subnormal or out of range; this is
+      // rare enough to leave these cases to big_decimal.
+
+      inline bool eisel_lemire( std::uint64_t m, const long q, const bool negative, double & result )
+      {
+         if ( ( q < min_power_of_ten ) || ( q > max_power_of_ten ) ) {
+            return false;
+         }
+         const int z = leading_zeros( m );
+         m <<= z;
+
+         // Rounds down log2( 10 ) * q, 217706 / 2^16 approximates log2( 10 ).
+         const long l = 217706 * q;
+         long exponent = ( ( l >= 0 ) ? ( l / 65536 ) : -( ( -l + 65535 ) / 65536 ) ) + 64 + 1023 - z;
+
+         const std::uint64_t * p = power_of_ten( int( q ) );
+         std::uint64_t high;
+         std::uint64_t low;
+         multiply( m, p[ 0 ], high, low );
+
+         if ( ( ( high & 0x1ff ) == 0x1ff ) && ( low + m < m ) ) {
+            // The lower 64 bits of the power of ten might carry into the relevant bits.
+            std::uint64_t h;
+            std::uint64_t l2;
+            multiply( m, p[ 1 ], h, l2 );
+            const std::uint64_t merged = low + h;
+            high += ( merged < low );
+            low = merged;
+            if ( ( ( high & 0x1ff ) == 0x1ff ) && ( low + 1 == 0 ) && ( l2 + m < m ) ) {
+               return false;
+            }
+         }
+         const unsigned top = unsigned( high >> 63 );
+         std::uint64_t mantissa = high >> ( top + 9 );
+         exponent -= 1 ^ top;
+
+         if ( ( low == 0 ) && ( ( high & 0x1ff ) == 0 ) && ( ( mantissa & 3 ) == 1 ) ) {
+            return false;  // Possibly exactly halfway between two doubles.
+         }
+         mantissa += mantissa & 1;
+         mantissa >>= 1;
+         if ( mantissa >> 53 ) {
+            mantissa >>= 1;
+            ++exponent;
+         }
+         if ( ( exponent <= 0 ) || ( exponent >= 0x7ff ) ) {
+            return false;
+         }
+         const std::uint64_t bits = ( std::uint64_t( exponent ) << 52 ) | ( mantissa & ( ( std::uint64_t( 1 ) << 52 ) - 1 ) ) | ( std::uint64_t( negative ) << 63 );
+         std::memcpy( & result, & bits, sizeof( result ) );
+         return true;
+      }
+
+      // Converts a decimal floating-point number with optional sign,
+      // optional fraction and optional exponent, for example as matched
+      // by json::number, into a double. Uses an exact fast path when the
+      // significand fits into 53 bits and the power of ten is exactly
+      // representable, then eisel_lemire() for up to 19 significant digits,
+      // e.g. all shortest or 17-digit representations of doubles, and
+      // big_decimal for all other cases; the result is always correctly
+      // rounded. Returns false when the value is out of range.
+
+      inline bool to_double( const char * begin, const char * const end, double & result )
+      {
+         static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+         const char * const start = begin;
+
+         const bool negative = ( begin != end ) && ( * begin == '-' );
+         if ( ( begin != end ) && ( ( * begin == '-' ) || ( * begin == '+' ) ) ) {
+            ++begin;
+         }
+         std::uint64_t m = 0;
+         int digits = 0;
+         long exponent = 0;
+
+         for ( ; ( begin != end ) && ( unsigned( * begin ) - '0' <= 9 ); ++begin ) {
+            digits += ( ( m != 0 ) || ( * begin != '0' ) );
+            m = m * 10 + unsigned( * begin - '0' );
+            if ( digits > 19 ) {
+               break;
+            }
+         }
+         if ( ( begin != end ) && ( * begin == '.' ) ) {
+            for ( ++begin; ( begin != end ) && ( unsigned( * begin ) - '0' <= 9 ); ++begin ) {
+               digits += ( ( m != 0 ) || ( * begin != '0' ) );
+               m = m * 10 + unsigned( * begin - '0' );
+               --exponent;
+               if ( digits > 19 ) {
+                  break;
+               }
+            }
+         }
+         if ( ( begin != end ) && ( ( * begin == 'e' ) || ( * begin == 'E' ) ) ) {
+            ++begin;
+            const bool minus = ( begin != end ) && ( * begin == '-' );
+            if ( ( begin != end ) && ( ( * begin == '-' ) || ( * begin == '+' ) ) ) {
+               ++begin;
+            }
+            long e = 0;
+            for ( ; ( begin != end ) && ( unsigned( * begin ) - '0' <= 9 ); ++begin ) {
+               if ( e < 100000 ) {
+                  e = e * 10 + ( * begin - '0' );
+               }
+            }
+            exponent += minus ? -e : e;
+         }
+         if ( ( digits <= 19 ) && ( begin == end ) ) {
+            if ( m == 0 ) {
+               result = negative ? -0.0 : 0.0;
+               return true;
+            }
+            if ( ( FLT_EVAL_METHOD == 0 ) && ( exponent > 22 ) && ( exponent <= 22 + 15 ) ) {
+               // The significand can absorb some of the power of ten when it is small enough.
+               for ( ; ( exponent > 22 ) && ( m <= ( std::uint64_t( 1 ) << 53 ) / 10 ); --exponent ) {
+                  m *= 10;
+               }
+            }
+            if ( ( FLT_EVAL_METHOD == 0 ) && ( m <= ( std::uint64_t( 1 ) << 53 ) ) && ( exponent >= -22 ) && ( exponent <= 22 ) ) {
+               // Both operands are exact, therefore the single rounding of the operation yields the correct result.
+               const double d = double( m );
+               result = ( exponent < 0 ) ? ( d / powers[ -exponent ] ) : ( d * powers[ exponent ] );
+               result = negative ? -result : result;
+               return true;
+            }
+            if ( eisel_lemire( m, exponent, negative, result ) ) {
+               return true;
+            }
+         }
+         result = big_decimal( start, end ).to_double();
+         return ! std::isinf( result );
+      }
+
+      // Actions for common conversion situations; the result is stored
+      // in the state's converted member, whose type determines the target
+      // type of the conversion.
+
+      struct integer
+      {
+         template< typename Input, typename State >
+         static void apply( const Input & in, State & st )
+         {
+            if ( ! to_integer( in.begin(), in.end(), st.converted ) ) {
+               throw parse_error( "integer out of range", in );
+            }
+         }
+      };
+
+      struct floating
+      {
+         template< typename Input, typename State >
+         static void apply( const Input & in, State & st )
+         {
+            double d;
+            if ( ! to_double( in.begin(), in.end(), d ) ) {
+               throw parse_error( "floating-point number out of range", in );
+            }
+            st.converted = d;
+         }
+      };
+
+      template< typename T >
+      struct state
+      {
+         T converted = T();
+      };
+
+   } // convert
+
+} // pegtl
+
+#endif
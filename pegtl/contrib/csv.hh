@@ -0,0 +1,245 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_CSV_HH
+#define PEGTL_CONTRIB_CSV_HH
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+#include "../ascii.hh"
+#include "../rules.hh"
+#include "../nothing.hh"
+
+#include "../internal/swar.hh"
+
+#include "../analysis/generic.hh"
+
+#include "view.hh"
+
+namespace pegtl
+{
+   namespace internal
+   {
+      // Returns the offset of the first byte at or behind offset i that is
+      // one of the Cs, or the size of the input when there is none. The
+      // scan asks for a larger block than needed so that buffer inputs do
+      // not read a few bytes at a time, unless the buffer is nearly full.
+
+      template< char ... Cs, typename Input >
+      std::size_t csv_find( Input & in, std::size_t i )
+      {
+         for ( ;; ) {
+            std::size_t s = in.size( i + 256 );
+            if ( i >= s ) {
+               s = in.size( i + 1 );
+               if ( i >= s ) {
+                  return s;
+               }
+            }
+            const char * p = in.begin();
+            while ( i + 8 <= s ) {
+               if ( const std::uint64_t m = swar_equal< Cs ... >( swar_load( p + i ) ) ) {
+                  return i + swar_count_leading( ~m & swar_broadcast( 0x80 ) );
+               }
+               i += 8;
+            }
+            while ( i < s ) {
+               if ( swar_equal< Cs ... >( std::uint64_t( static_cast< unsigned char >( p[ i ] ) ) ) & 0x80 ) {
+                  return i;
+               }
+               ++i;
+            }
+         }
+      }
+
+      // An unquoted field, i.e. everything up to the next delimiter, quote
+      // or line break; the quote is only allowed in quoted fields.
+
+      template< char Delimiter, char Quote >
+      struct csv_plain
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::OPT >;
+
+         template< typename Input >
+         static bool match( Input & in )
+         {
+            in.bump_in_this_line( csv_find< Delimiter, Quote, '\r', '\n' >( in, 0 ) );
+            return true;
+         }
+      };
+
+      // A quoted field that can contain delimiters and line breaks; when
+      // Escape is the Quote an escaped quote is written as two quotes.
+
+      template< char Quote, char Escape >
+      struct csv_quoted
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::ANY >;
+
+         template< typename Input >
+         static bool match( Input & in )
+         {
+            if ( in.empty() || ( in.peek_char() != Quote ) ) {
+               return false;
+            }
+            bool lines = false;
+            std::size_t i = 1;
+            for ( ;; ) {
+               i = csv_find< Quote, Escape, '\n' >( in, i );
+               const std::size_t s = in.size( i + 2 );
+               if ( i >= s ) {
+                  return false;
+               }
+               const char c = in.peek_char( i );
+               if ( ( c == Escape ) && ( ( Escape != Quote ) || ( ( i + 1 < s ) && ( in.peek_char( i + 1 ) == Quote ) ) ) ) {
+                  if ( i + 1 >= s ) {
+                     return false;
+                  }
+                  lines |= ( in.peek_char( i + 1 ) == '\n' );
+                  i += 2;
+               }
+               else if ( c == Quote ) {
+                  if ( lines ) {
+                     in.bump( i + 1 );
+                  }
+                  else {
+                     in.bump_in_this_line( i + 1 );
+                  }
+                  return true;
+               }
+               else {
+                  lines = true;
+                  ++i;
+               }
+            }
+         }
+      };
+
+   } // internal
+
+   namespace csv
+   {
+      // Delimited text according to RFC 4180, with configurable delimiter,
+      // quote and escape characters, e.g. dialect< '\t' > for tab separated
+      // values or dialect< ',', '"', '\\' > for backslash escapes. Lines can
+      // end with CR LF or LF, the last line break is optional.
+
+      template< char Delimiter = ',', char Quote = '"', char Escape = Quote >
+      struct dialect
+      {
+         static constexpr char delimiter = Delimiter;
+         static constexpr char quote = Quote;
+         static constexpr char escape = Escape;
+      };
+
+      using rfc4180 = dialect<>;
+
+      template< typename Dialect > struct plain_field : internal::csv_plain< Dialect::delimiter, Dialect::quote > {};
+      template< typename Dialect > struct quoted_field : internal::csv_quoted< Dialect::quote, Dialect::escape > {};
+      template< typename Dialect > struct field : sor< quoted_field< Dialect >, plain_field< Dialect > > {};
+      template< typename Dialect > struct record : list< field< Dialect >, one< Dialect::delimiter > > {};
+
+      // A row only matches without consuming at the end of the input, where
+      // file does not try it, therefore the analysis treats it like a row
+      // that is always followed by a line break.
+
+      template< typename Dialect > struct row : seq< record< Dialect >, eolf >
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::SEQ, record< Dialect >, eol >;
+      };
+
+      // The rows are discarded after their actions, so that a buffer_input
+      // only needs to hold one row at a time.
+
+      template< typename Dialect = rfc4180 > struct file : until< eof, must< row< Dialect > >, discard > {};
+
+      // A field as a view of the input; the content of a quoted field is
+      // without the quotes, but still contains the escape sequences.
+
+      struct field_view
+      {
+         view content;
+         bool quoted;
+      };
+
+      // Copies the content of a field to string s, without escapes.
+
+      template< typename Dialect >
+      void unescape( const field_view & f, std::string & s )
+      {
+         s.clear();
+         if ( ! f.quoted ) {
+            s.assign( f.content.begin(), f.content.end() );
+            return;
+         }
+         s.reserve( f.content.size );
+         for ( const char * p = f.content.begin(); p != f.content.end(); ++p ) {
+            if ( ( * p == Dialect::escape ) && ( p + 1 != f.content.end() ) ) {
+               ++p;
+            }
+            s += * p;
+         }
+      }
+
+      // State for row_action: collects the fields of a row and calls the
+      // function with a const std::vector< field_view > & at the end of
+      // every row, before the row is discarded; the views are only valid
+      // during the call.
+
+      template< typename F >
+      struct row_handler
+      {
+         explicit
+         row_handler( F && in_function )
+               : function( std::forward< F >( in_function ) )
+         { }
+
+         F function;
+         std::vector< field_view > fields;
+      };
+
+      template< typename F >
+      row_handler< F > make_row_handler( F && f )
+      {
+         return row_handler< F >( std::forward< F >( f ) );
+      }
+
+      template< typename Rule > struct row_action : nothing< Rule > {};
+
+      template< typename Dialect > struct row_action< plain_field< Dialect > >
+      {
+         template< typename Input, typename Handler >
+         static void apply( const Input & in, Handler & h )
+         {
+            h.fields.push_back( field_view{ view( in.begin(), in.size() ), false } );
+         }
+      };
+
+      template< typename Dialect > struct row_action< quoted_field< Dialect > >
+      {
+         template< typename Input, typename Handler >
+         static void apply( const Input & in, Handler & h )
+         {
+            h.fields.push_back( field_view{ view( in.begin() + 1, in.size() - 2 ), true } );
+         }
+      };
+
+      template< typename Dialect > struct row_action< row< Dialect > >
+      {
+         template< typename Input, typename Handler >
+         static void apply( const Input &, Handler & h )
+         {
+            h.function( const_cast< const std::vector< field_view > & >( h.fields ) );
+            h.fields.clear();
+         }
+      };
+
+   } // csv
+
+} // pegtl
+
+#endif
@@ -0,0 +1,373 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_DEFERRED_HH
+#define PEGTL_CONTRIB_DEFERRED_HH
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+#include "../normal.hh"
+#include "../nothing.hh"
+#include "../apply_mode.hh"
+#include "../action_input.hh"
+
+#include "../internal/seq.hh"
+#include "../internal/input_mark.hh"
+#include "../internal/skip_control.hh"
+#include "../internal/rule_match_two.hh"
+#include "../internal/rule_match_three.hh"
+
+#include "../analysis/generic.hh"
+
+namespace pegtl
+{
+   // The action tape records which actions would have been applied, and
+   // to which part of the input, instead of applying them immediately.
+   // Entries are removed again when the input is rewound, and the tape
+   // is replayed with the states of the parsing run on commit<> or when
+   // the top-level rule succeeds.
+
+   template< typename ... States >
+   class action_tape
+   {
+   public:
+      using apply_t = void ( * )( const action_input &, States & ... );
+
+      struct entry
+      {
+         apply_t apply;
+         std::size_t line;
+         std::size_t byte_in_line;
+         const char * begin;
+         const char * end;
+      };
+
+      explicit
+      action_tape( const char * in_source )
+            : m_source( in_source )
+      { }
+
+      action_tape( const action_tape & ) = delete;
+      void operator= ( const action_tape & ) = delete;
+
+      bool empty() const
+      {
+         return m_entries.empty();
+      }
+
+      std::size_t size() const
+      {
+         return m_entries.size();
+      }
+
+      // The position includes all entries that were already replayed
+      // so that marks taken before a commit<> remain meaningful.
+
+      std::size_t position() const
+      {
+         return m_replayed + m_entries.size();
+      }
+
+      template< typename Action >
+      void record( const std::size_t line, const std::size_t byte_in_line, const char * begin, const char * end )
+      {
+         m_entries.push_back( entry{ & apply_one< Action >, line, byte_in_line, begin, end } );
+      }
+
+      void rewind( const std::size_t position )
+      {
+         m_entries.resize( ( position > m_replayed ) ? ( position - m_replayed ) : 0 );
+      }
+
+      void replay( States & ... st )
+      {
+         // Entries are consumed one by one so that an exception thrown
+         // by an action leaves only the not-yet-applied entries behind.
+
+         std::size_t i = 0;
+         try {
+            for ( ; i < m_entries.size(); ++i ) {
+               const auto & e = m_entries[ i ];
+               e.apply( action_input( e.line, e.byte_in_line, e.begin, e.end, m_source ), st ... );
+            }
+         }
+         catch ( ... ) {
+            erase_front( i );
+            throw;
+         }
+         erase_front( i );
+      }
+
+   private:
+      template< typename Action >
+      static void apply_one( const action_input & in, States & ... st )
+      {
+         Action::apply( in, st ... );
+      }
+
+      void erase_front( const std::size_t count )
+      {
+         m_entries.erase( m_entries.begin(), m_entries.begin() + count );
+         m_replayed += count;
+      }
+
+      const char * m_source;
+      std::size_t m_replayed = 0;
+      std::vector< entry > m_entries;
+   };
+
+   namespace internal
+   {
+      template< typename Tape >
+      class deferred_mark
+      {
+      public:
+         deferred_mark( input_mark && m, Tape & t )
+               : m_mark( std::move( m ) ),
+                 m_position( t.position() ),
+                 m_tape( & t )
+         { }
+
+         deferred_mark( deferred_mark && m )
+               : m_mark( std::move( m.m_mark ) ),
+                 m_position( m.m_position ),
+                 m_tape( m.m_tape )
+         {
+            m.m_tape = nullptr;
+         }
+
+         ~deferred_mark()
+         {
+            if ( m_tape ) {
+               m_tape->rewind( m_position );
+            }
+         }
+
+         deferred_mark( const deferred_mark & ) = delete;
+         void operator= ( const deferred_mark & ) = delete;
+
+         bool operator() ( const bool result )
+         {
+            if ( result ) {
+               m_tape = nullptr;
+            }
+            return m_mark( result );
+         }
+
+         std::size_t line() const
+         {
+            return m_mark.line();
+         }
+
+         std::size_t byte_in_line() const
+         {
+            return m_mark.byte_in_line();
+         }
+
+         const char * begin() const
+         {
+            return m_mark.begin();
+         }
+
+      private:
+         input_mark m_mark;
+         const std::size_t m_position;
+         Tape * m_tape;
+      };
+
+   } // internal
+
+   // The deferred_input wraps another input, forwards all operations to it,
+   // and associates an action tape with the input whose entries are rewound
+   // together with the input position.
+   //
+   // Incremental inputs MUST NOT discard() data that is still referenced by
+   // entries on the tape, i.e. use commit<> before any discarding rule.
+
+   template< typename Input, typename ... States >
+   class deferred_input
+   {
+   public:
+      using tape_t = action_tape< States ... >;
+
+      explicit
+      deferred_input( Input & in )
+            : m_input( in ),
+              m_tape( in.source() )
+      { }
+
+      deferred_input( const deferred_input & ) = delete;
+      void operator= ( const deferred_input & ) = delete;
+
+      bool empty()
+      {
+         return m_input.empty();
+      }
+
+      std::size_t size( const std::size_t amount )
+      {
+         return m_input.size( amount );
+      }
+
+      const char * begin() const
+      {
+         return m_input.begin();
+      }
+
+      const char * end( const std::size_t amount )
+      {
+         return m_input.end( amount );
+      }
+
+      std::size_t line() const
+      {
+         return m_input.line();
+      }
+
+      std::size_t byte_in_line() const
+      {
+         return m_input.byte_in_line();
+      }
+
+      const char * source() const
+      {
+         return m_input.source();
+      }
+
+      char peek_char( const std::size_t offset = 0 ) const
+      {
+         return m_input.peek_char( offset );
+      }
+
+      unsigned char peek_byte( const std::size_t offset = 0 ) const
+      {
+         return m_input.peek_byte( offset );
+      }
+
+      void bump( const std::size_t count = 1 )
+      {
+         m_input.bump( count );
+      }
+
+      void bump_in_this_line( const std::size_t count = 1 )
+      {
+         m_input.bump_in_this_line( count );
+      }
+
+      void bump_to_next_line( const std::size_t count = 1 )
+      {
+         m_input.bump_to_next_line( count );
+      }
+
+      void discard()
+      {
+         m_input.discard();
+      }
+
+      void require( const std::size_t amount )
+      {
+         m_input.require( amount );
+      }
+
+      internal::deferred_mark< tape_t > mark()
+      {
+         return internal::deferred_mark< tape_t >( m_input.mark(), m_tape );
+      }
+
+      tape_t & tape()
+      {
+         return m_tape;
+      }
+
+   private:
+      Input & m_input;
+      tape_t m_tape;
+   };
+
+   // Control class that records actions on the tape of a deferred_input
+   // instead of applying them. Note that the match() of the Base control
+   // is bypassed for rules that have an action, and that only actions
+   // called with the states of the parsing run can be deferred, i.e. this
+   // does not combine with state<> or change_state<>.
+
+   template< typename Rule, template< typename ... > class Base = normal >
+   struct deferred
+         : public Base< Rule >
+   {
+      template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static typename std::enable_if< ( A == apply_mode::ACTION ) && ( ! is_nothing< Action, Rule >::value ) && ( ! internal::skip_control< Rule >::value ), bool >::type
+      match( Input & in, States && ... st )
+      {
+         const auto line = in.line();
+         const auto byte_in_line = in.byte_in_line();
+         const auto * const begin = in.begin();
+
+         if ( internal::rule_match_two< Rule, A, Action, Control, false >::match( in, st ... ) ) {
+            in.tape().template record< Action< Rule > >( line, byte_in_line, begin, in.begin() );
+            return true;
+         }
+         return false;
+      }
+
+      template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static typename std::enable_if< ! ( ( A == apply_mode::ACTION ) && ( ! is_nothing< Action, Rule >::value ) && ( ! internal::skip_control< Rule >::value ) ), bool >::type
+      match( Input & in, States && ... st )
+      {
+         return Base< Rule >::template match< A, Action, Control >( in, st ... );
+      }
+   };
+
+   template< template< typename ... > class Base >
+   struct deferred_helper
+   {
+      template< typename Rule > using control = deferred< Rule, Base >;
+   };
+
+   namespace internal
+   {
+      template< typename ... Rules >
+      struct commit
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::SEQ, Rules ... >;
+
+         template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+         static bool match( Input & in, States && ... st )
+         {
+            if ( rule_match_three< seq< Rules ... >, A, Action, Control >::match( in, st ... ) ) {
+               in.tape().replay( st ... );
+               return true;
+            }
+            return false;
+         }
+      };
+
+      template< typename ... Rules >
+      struct skip_control< commit< Rules ... > > : std::true_type {};
+
+   } // internal
+
+   // Matches like seq< Rules ... > and, on success, applies all actions
+   // recorded so far. Actions applied by a commit<> are not undone when
+   // an enclosing rule fails later, so commit<> should only be used at
+   // points where the grammar does not backtrack, e.g. after a must<>.
+
+   template< typename ... Rules > struct commit : internal::commit< Rules ... > {};
+
+   template< typename Rule, template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename Input, typename ... States >
+   bool parse_input_deferred( Input & in, States && ... st )
+   {
+      deferred_input< Input, typename std::remove_reference< States >::type ... > di( in );
+
+      if ( deferred_helper< Control >::template control< Rule >::template match< apply_mode::ACTION, Action, deferred_helper< Control >::template control >( di, st ... ) ) {
+         di.tape().replay( st ... );
+         return true;
+      }
+      return false;
+   }
+
+} // pegtl
+
+#endif
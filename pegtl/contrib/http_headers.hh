@@ -0,0 +1,322 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_HTTP_HEADERS_HH
+#define PEGTL_CONTRIB_HTTP_HEADERS_HH
+
+#include <cstddef>
+
+#include "../parse.hh"
+#include "../rules.hh"
+#include "../nothing.hh"
+#include "../apply_mode.hh"
+
+#include "../analysis/generic.hh"
+
+#include "http.hh"
+
+namespace pegtl
+{
+   namespace http
+   {
+      // Well-known header fields; the order has to match the names in
+      // internal::http_header_names below.
+
+      enum class known_header : unsigned char
+      {
+         UNKNOWN,
+         ACCEPT,
+         ACCEPT_CHARSET,
+         ACCEPT_ENCODING,
+         ACCEPT_LANGUAGE,
+         ACCEPT_RANGES,
+         AGE,
+         ALLOW,
+         AUTHORIZATION,
+         CACHE_CONTROL,
+         CONNECTION,
+         CONTENT_ENCODING,
+         CONTENT_LANGUAGE,
+         CONTENT_LENGTH,
+         CONTENT_LOCATION,
+         CONTENT_RANGE,
+         CONTENT_TYPE,
+         COOKIE,
+         DATE,
+         ETAG,
+         EXPECT,
+         EXPIRES,
+         FORWARDED,
+         HOST,
+         IF_MATCH,
+         IF_MODIFIED_SINCE,
+         IF_NONE_MATCH,
+         IF_RANGE,
+         IF_UNMODIFIED_SINCE,
+         KEEP_ALIVE,
+         LAST_MODIFIED,
+         LOCATION,
+         MAX_FORWARDS,
+         ORIGIN,
+         PRAGMA,
+         PROXY_AUTHENTICATE,
+         PROXY_AUTHORIZATION,
+         PROXY_CONNECTION,
+         RANGE,
+         REFERER,
+         RETRY_AFTER,
+         SERVER,
+         SET_COOKIE,
+         TE,
+         TRAILER,
+         TRANSFER_ENCODING,
+         UPGRADE,
+         USER_AGENT,
+         VARY,
+         VIA,
+         WARNING,
+         WWW_AUTHENTICATE,
+         X_FORWARDED_FOR,
+         X_FORWARDED_PROTO,
+         X_REQUEST_ID
+      };
+
+   } // http
+
+   namespace internal
+   {
+      template< typename = void >
+      struct http_header_names
+      {
+         static constexpr const char * name[] = {
+            "",
+            "accept", "accept-charset", "accept-encoding", "accept-language", "accept-ranges", "age", "allow", "authorization", "cache-control", "connection",
+            "content-encoding", "content-language", "content-length", "content-location", "content-range", "content-type", "cookie", "date", "etag", "expect",
+            "expires", "forwarded", "host", "if-match", "if-modified-since", "if-none-match", "if-range", "if-unmodified-since", "keep-alive", "last-modified",
+            "location", "max-forwards", "origin", "pragma", "proxy-authenticate", "proxy-authorization", "proxy-connection", "range", "referer", "retry-after",
+            "server", "set-cookie", "te", "trailer", "transfer-encoding", "upgrade", "user-agent", "vary", "via", "warning",
+            "www-authenticate", "x-forwarded-for", "x-forwarded-proto", "x-request-id"
+         };
+      };
+
+      template< typename T > constexpr const char * http_header_names< T >::name[];
+
+      constexpr unsigned http_header_count = sizeof( http_header_names<>::name ) / sizeof( http_header_names<>::name[ 0 ] );
+
+      static_assert( http_header_count == unsigned( http::known_header::X_REQUEST_ID ) + 1, "http::known_header does not match the header names" );
+
+      constexpr std::size_t http_length( const char * s )
+      {
+         return * s ? ( 1 + http_length( s + 1 ) ) : 0;
+      }
+
+      // The perfect hash looks at the length and at three bytes, all of
+      // which are folded with 0x20; this maps some different non-letters
+      // to the same value, but the candidate is always compared in full.
+
+      constexpr std::size_t http_fold( const char c )
+      {
+         return std::size_t( ( unsigned char )( c ) | 0x20 );
+      }
+
+      constexpr std::size_t http_header_hash( const char * s, const std::size_t n )
+      {
+         return ( n * 11 + http_fold( s[ 0 ] ) * 7 + http_fold( s[ n - 1 ] ) * 39 + http_fold( s[ n / 2 ] ) * 28 ) & 127;
+      }
+
+      constexpr std::size_t http_header_hash( const unsigned i )
+      {
+         return http_header_hash( http_header_names<>::name[ i ], http_length( http_header_names<>::name[ i ] ) );
+      }
+
+      // The index of the first header name with hash h, or 0 for none.
+
+      constexpr unsigned char http_header_slot( const std::size_t h, const unsigned i = 1 )
+      {
+         return ( i == http_header_count ) ? 0 : ( http_header_hash( i ) == h ) ? ( unsigned char )( i ) : http_header_slot( h, i + 1 );
+      }
+
+      constexpr bool http_header_perfect( const unsigned i = 1 )
+      {
+         return ( i == http_header_count ) || ( ( http_header_slot( http_header_hash( i ) ) == i ) && http_header_perfect( i + 1 ) );
+      }
+
+      static_assert( http_header_perfect(), "the hash of the http header names has collisions" );
+
+      template< unsigned N, unsigned ... Is >
+      struct http_header_table
+            : http_header_table< N - 1, N - 1, Is ... >
+      { };
+
+      template< unsigned ... Is >
+      struct http_header_table< 0, Is ... >
+      {
+         static constexpr unsigned char slot[] = { http_header_slot( Is ) ... };
+      };
+
+      template< unsigned ... Is > constexpr unsigned char http_header_table< 0, Is ... >::slot[];
+
+      inline bool http_header_equal( const char * data, const std::size_t size, const char * name )
+      {
+         for ( std::size_t i = 0; i < size; ++i ) {
+            const char c = data[ i ];
+            if ( ( ! name[ i ] ) || ( ( ( ( c >= 'A' ) && ( c <= 'Z' ) ) ? char( c | 0x20 ) : c ) != name[ i ] ) ) {
+               return false;
+            }
+         }
+         return ! name[ size ];
+      }
+
+   } // internal
+
+   namespace http
+   {
+      // Classifies a field name with a single table lookup and comparison.
+
+      inline known_header classify_header( const char * data, const std::size_t size )
+      {
+         if ( ! size ) {
+            return known_header::UNKNOWN;
+         }
+         const unsigned i = internal::http_header_table< 128 >::slot[ internal::http_header_hash( data, size ) ];
+         return internal::http_header_equal( data, size, internal::http_header_names<>::name[ i ] ) ? known_header( i ) : known_header::UNKNOWN;
+      }
+
+      // Returns the canonical lower-case name, or "" for UNKNOWN.
+
+      inline const char * known_header_name( const known_header h )
+      {
+         return internal::http_header_names<>::name[ unsigned( h ) ];
+      }
+
+      // The grammar for the value of a header field, i.e. field_value for
+      // the headers without a more specific grammar in http.hh.
+
+      template< known_header H > struct header_value_rule { using type = field_value; };
+
+      template<> struct header_value_rule< known_header::CONNECTION > { using type = Connection; };
+      template<> struct header_value_rule< known_header::CONTENT_LENGTH > { using type = Content_Length; };
+      template<> struct header_value_rule< known_header::HOST > { using type = Host; };
+      template<> struct header_value_rule< known_header::TE > { using type = TE; };
+      template<> struct header_value_rule< known_header::TRAILER > { using type = Trailer; };
+      template<> struct header_value_rule< known_header::TRANSFER_ENCODING > { using type = Transfer_Encoding; };
+      template<> struct header_value_rule< known_header::UPGRADE > { using type = Upgrade; };
+      template<> struct header_value_rule< known_header::VIA > { using type = Via; };
+
+      // Matches the value of a classified header field, without the optional
+      // whitespace around it, against the grammar for the header, applying
+      // the actions to the matched rules. Like the parse functions, a global
+      // error in the value grammar raises a parse_error. This is a second
+      // pass over a value that was already matched, e.g. by header_field;
+      // typed_header_field below does both in one pass.
+
+      template< known_header H, template< typename ... > class Action = nothing, typename ... States >
+      bool parse_header_value( const char * data, const std::size_t size, States && ... st )
+      {
+         return parse_memory< seq< typename header_value_rule< H >::type, eof >, Action >( data, data + size, known_header_name( H ), st ... );
+      }
+
+      template< template< typename ... > class Action = nothing, typename ... States >
+      bool parse_header_value( const known_header h, const char * data, const std::size_t size, States && ... st )
+      {
+         switch ( h ) {
+            case known_header::CONNECTION:
+               return parse_header_value< known_header::CONNECTION, Action >( data, size, st ... );
+            case known_header::CONTENT_LENGTH:
+               return parse_header_value< known_header::CONTENT_LENGTH, Action >( data, size, st ... );
+            case known_header::HOST:
+               return parse_header_value< known_header::HOST, Action >( data, size, st ... );
+            case known_header::TE:
+               return parse_header_value< known_header::TE, Action >( data, size, st ... );
+            case known_header::TRAILER:
+               return parse_header_value< known_header::TRAILER, Action >( data, size, st ... );
+            case known_header::TRANSFER_ENCODING:
+               return parse_header_value< known_header::TRANSFER_ENCODING, Action >( data, size, st ... );
+            case known_header::UPGRADE:
+               return parse_header_value< known_header::UPGRADE, Action >( data, size, st ... );
+            case known_header::VIA:
+               return parse_header_value< known_header::VIA, Action >( data, size, st ... );
+            default:
+               return parse_header_value< known_header::UNKNOWN, Action >( data, size, st ... );
+         }
+      }
+
+      // The value of a header field with the grammar for the header, without
+      // the optional whitespace around it; e.g. an action for header_value<
+      // known_header::HOST > only sees the values of Host headers.
+
+      template< known_header H > struct header_value : header_value_rule< H >::type {};
+
+      // Rule that matches like header_field, but with the grammar for the
+      // value chosen by the known_header of the field name, all in the same
+      // pass: the name is classified right after it was matched, then the
+      // header_value< H > for the classified name is matched in place, and
+      // followed by the optional whitespace up to the end of the line.
+
+      struct typed_header_field
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::SEQ, field_name, one< ':' >, OWS, field_value, OWS >;
+
+         template< known_header H, apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+         static bool match_value( Input & in, States && ... st )
+         {
+            return Control< header_value< H > >::template match< A, Action, Control >( in, st ... );
+         }
+
+         template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+         static bool match_value( const known_header h, Input & in, States && ... st )
+         {
+            switch ( h ) {
+               case known_header::CONNECTION:
+                  return match_value< known_header::CONNECTION, A, Action, Control >( in, st ... );
+               case known_header::CONTENT_LENGTH:
+                  return match_value< known_header::CONTENT_LENGTH, A, Action, Control >( in, st ... );
+               case known_header::HOST:
+                  return match_value< known_header::HOST, A, Action, Control >( in, st ... );
+               case known_header::TE:
+                  return match_value< known_header::TE, A, Action, Control >( in, st ... );
+               case known_header::TRAILER:
+                  return match_value< known_header::TRAILER, A, Action, Control >( in, st ... );
+               case known_header::TRANSFER_ENCODING:
+                  return match_value< known_header::TRANSFER_ENCODING, A, Action, Control >( in, st ... );
+               case known_header::UPGRADE:
+                  return match_value< known_header::UPGRADE, A, Action, Control >( in, st ... );
+               case known_header::VIA:
+                  return match_value< known_header::VIA, A, Action, Control >( in, st ... );
+               default:
+                  return match_value< known_header::UNKNOWN, A, Action, Control >( in, st ... );
+            }
+         }
+
+         template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+         static bool match( Input & in, States && ... st )
+         {
+            auto m = in.mark();
+            const char * name = in.begin();
+            if ( ! Control< field_name >::template match< A, Action, Control >( in, st ... ) ) {
+               return false;
+            }
+            const known_header h = classify_header( name, std::size_t( in.begin() - name ) );
+            return m( Control< seq< one< ':' >, OWS > >::template match< A, Action, Control >( in, st ... ) && match_value< A, Action, Control >( h, in, st ... ) && Control< seq< OWS, at< sor< CRLF, eof > > > >::template match< A, Action, Control >( in, st ... ) );
+         }
+      };
+
+      // Action for field_name that classifies the name into a known_header
+      // during the parsing of the header, for grammars with own actions.
+
+      template< typename Rule > struct classify_action : nothing< Rule > {};
+
+      template<> struct classify_action< field_name >
+      {
+         template< typename Input, typename ... States >
+         static void apply( const Input & in, known_header & h, States && ... )
+         {
+            h = classify_header( in.begin(), in.size() );
+         }
+      };
+
+   } // http
+
+} // pegtl
+
+#endif
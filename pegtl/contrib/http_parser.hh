@@ -0,0 +1,733 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_HTTP_PARSER_HH
+#define PEGTL_CONTRIB_HTTP_PARSER_HH
+
+#include <limits>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#include "../parse.hh"
+#include "../nothing.hh"
+#include "../parse_error.hh"
+
+#include "../internal/swar.hh"
+
+#include "http.hh"
+#include "view.hh"
+#include "http_headers.hh"
+
+namespace pegtl
+{
+   namespace http
+   {
+      using pegtl::view;
+
+      struct header
+      {
+         view name;
+         view value;  // Without the optional whitespace around it.
+         known_header id;
+      };
+
+      enum class parse_status : char
+      {
+         COMPLETE,    // The message (head) was parsed, see consumed.
+         INCOMPLETE,  // More input is required.
+         INVALID      // Invalid input, or more headers than the capacity.
+      };
+
+      // How the length of the body of a message is determined, see RFC 7230,
+      // section 3.3.3.
+
+      enum class body_kind : char
+      {
+         NONE,     // There is no body.
+         LENGTH,   // The body has the given length.
+         CHUNKED,  // The body uses the chunked transfer coding, see chunked_decoder.
+         CLOSE,    // The body of a response extends until the connection is closed.
+         INVALID   // Invalid or conflicting Content-Length headers.
+      };
+
+      // The start line and the headers of a message; the header array has a
+      // fixed capacity, messages with more headers are rejected.
+
+      template< std::size_t Capacity >
+      struct message_head
+      {
+         static_assert( Capacity > 0, "http::message_head needs a capacity for at least one header" );
+
+         int major_version = 0;
+         int minor_version = 0;
+
+         std::size_t header_count = 0;
+         header headers[ Capacity ];
+
+         const header * begin() const
+         {
+            return headers;
+         }
+
+         const header * end() const
+         {
+            return headers + header_count;
+         }
+
+         // Returns the first header with the given name, or nullptr.
+
+         const header * find( const char * name ) const
+         {
+            for ( const auto & h : * this ) {
+               if ( h.name.iequal( name ) ) {
+                  return & h;
+               }
+            }
+            return nullptr;
+         }
+
+         const header * find( const known_header id ) const
+         {
+            for ( const auto & h : * this ) {
+               if ( h.id == id ) {
+                  return & h;
+               }
+            }
+            return nullptr;
+         }
+
+         // Whether the last transfer coding of the Transfer-Encoding headers
+         // is chunked.
+
+         bool chunked() const
+         {
+            const header * last = nullptr;
+            for ( const auto & h : * this ) {
+               if ( h.id == known_header::TRANSFER_ENCODING ) {
+                  last = & h;
+               }
+            }
+            if ( ! last ) {
+               return false;
+            }
+            const char * b = last->value.begin();
+            const char * e = last->value.end();
+            while ( ( e != b ) && ( ( e[ -1 ] == ' ' ) || ( e[ -1 ] == '\t' ) || ( e[ -1 ] == ',' ) ) ) {
+               --e;
+            }
+            const std::size_t n = sizeof( "chunked" ) - 1;
+            if ( ( std::size_t( e - b ) < n ) || ! view( e - n, n ).iequal( "chunked" ) ) {
+               return false;
+            }
+            const char * c = e - n;
+            return ( c == b ) || ( c[ -1 ] == ' ' ) || ( c[ -1 ] == '\t' ) || ( c[ -1 ] == ',' );
+         }
+
+         // Returns LENGTH and sets length when there are one or more equal
+         // Content-Length headers, NONE when there are none.
+
+         body_kind content_length( std::size_t & length ) const
+         {
+            body_kind nrv = body_kind::NONE;
+            for ( const auto & h : * this ) {
+               if ( h.id == known_header::CONTENT_LENGTH ) {
+                  std::size_t n = 0;
+                  if ( h.value.empty() ) {
+                     return body_kind::INVALID;
+                  }
+                  for ( const char c : h.value ) {
+                     if ( ( c < '0' ) || ( c > '9' ) || ( n > ( std::numeric_limits< std::size_t >::max() - 9 ) / 10 ) ) {
+                        return body_kind::INVALID;
+                     }
+                     n = n * 10 + std::size_t( c - '0' );
+                  }
+                  if ( ( nrv == body_kind::LENGTH ) && ( n != length ) ) {
+                     return body_kind::INVALID;
+                  }
+                  nrv = body_kind::LENGTH;
+                  length = n;
+               }
+            }
+            return nrv;
+         }
+
+         // Used by the actions.
+
+         bool overflow = false;
+
+         void add_name( const view & name )
+         {
+            if ( header_count < Capacity ) {
+               headers[ header_count++ ] = header{ name, view(), classify_header( name.data, name.size ) };
+            }
+            else {
+               overflow = true;
+            }
+         }
+
+         void set_value( const view & value )
+         {
+            if ( ! overflow ) {
+               headers[ header_count - 1 ].value = value;
+            }
+         }
+
+         void clear()
+         {
+            major_version = 0;
+            minor_version = 0;
+            header_count = 0;
+            overflow = false;
+         }
+      };
+
+      template< std::size_t Capacity = 64 >
+      struct request
+            : message_head< Capacity >
+      {
+         view method;
+         view target;
+
+         body_kind body( std::size_t & length ) const
+         {
+            if ( this->find( known_header::TRANSFER_ENCODING ) ) {
+               return this->chunked() ? body_kind::CHUNKED : body_kind::INVALID;
+            }
+            return this->content_length( length );
+         }
+      };
+
+      template< std::size_t Capacity = 64 >
+      struct response
+            : message_head< Capacity >
+      {
+         int status = 0;
+         view reason;
+
+         // The body of responses to HEAD requests is always empty, which
+         // the caller has to take into account.
+
+         body_kind body( std::size_t & length ) const
+         {
+            if ( ( status < 200 ) || ( status == 204 ) || ( status == 304 ) ) {
+               return body_kind::NONE;
+            }
+            if ( this->find( known_header::TRANSFER_ENCODING ) ) {
+               return this->chunked() ? body_kind::CHUNKED : body_kind::CLOSE;
+            }
+            const body_kind k = this->content_length( length );
+            return ( k == body_kind::NONE ) ? body_kind::CLOSE : k;
+         }
+      };
+
+      // The grammar of a complete head; parse_request() and parse_response()
+      // accept the same inputs, but scan them without the grammar.
+
+      struct request_head : seq< request_line, star< header_field, CRLF >, CRLF, eof > {};
+      struct response_head : seq< status_line, star< header_field, CRLF >, CRLF, eof > {};
+
+      struct chunk_line : seq< chunk_size, opt< chunk_ext >, CRLF, eof > {};
+      struct trailer_line : seq< header_field, CRLF, eof > {};
+
+      template< typename Rule > struct chunk_action : nothing< Rule > {};
+
+      template<> struct chunk_action< chunk_size >
+      {
+         template< typename Input >
+         static void apply( const Input & in, std::size_t & size )
+         {
+            std::size_t n = 0;
+            for ( const char * p = in.begin(); p != in.end(); ++p ) {
+               if ( n > ( std::numeric_limits< std::size_t >::max() >> 4 ) ) {
+                  throw parse_error( "chunk size too large", in );
+               }
+               const char c = * p | 0x20;
+               n = ( n << 4 ) + std::size_t( ( c <= '9' ) ? ( c - '0' ) : ( c - 'a' + 10 ) );
+            }
+            size = n;
+         }
+      };
+
+   } // http
+
+   namespace internal
+   {
+      // Returns the offset behind the first CR LF CR LF in data, starting
+      // the search at offset start, or 0 when there is none.
+
+      inline std::size_t http_head_end( const char * data, const std::size_t size, const std::size_t start )
+      {
+         const char * p = data + start;
+         const char * const end = data + size;
+         while ( p != end ) {
+            while ( ( end - p >= 8 ) && ! swar_has_byte< '\n' >( swar_load( p ) ) ) {
+               p += 8;
+            }
+            p = static_cast< const char * >( std::memchr( p, '\n', std::size_t( end - p ) ) );
+            if ( ! p ) {
+               return 0;
+            }
+            if ( ( p - data >= 3 ) && ( p[ -1 ] == '\r' ) && ( p[ -2 ] == '\n' ) && ( p[ -3 ] == '\r' ) ) {
+               return std::size_t( p + 1 - data );
+            }
+            ++p;
+         }
+         return 0;
+      }
+
+      // The heads of messages are parsed in a single pass that accepts the
+      // same inputs as http::request_head and http::response_head. Tokens,
+      // the path of the request target, header values and reason phrases
+      // are scanned eight bytes at a time while these are letters, digits
+      // or the most frequent punctuation, respectively text, the remaining
+      // bytes are checked one at a time. Every step returns INCOMPLETE when
+      // the input ends before it could decide, and INVALID on a mismatch.
+
+      inline bool http_alnum( const char c )
+      {
+         return ( ( c >= '0' ) && ( c <= '9' ) ) || ( ( ( c | 0x20 ) >= 'a' ) && ( ( c | 0x20 ) <= 'z' ) );
+      }
+
+      inline bool http_tchar( const char c )
+      {
+         switch ( c ) {
+            case '!': case '#': case '$': case '%': case '&': case '\'': case '*': case '+': case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+               return true;
+            default:
+               return http_alnum( c );
+         }
+      }
+
+      // The pchar of RFC 3986 except for percent-encoding, and '/' and '?'.
+
+      inline bool http_path_char( const char c )
+      {
+         switch ( c ) {
+            case '-': case '.': case '_': case '~': case '!': case '$': case '&': case '\'': case '(': case ')': case '*': case '+': case ',': case ';': case '=': case ':': case '@': case '/': case '?':
+               return true;
+            default:
+               return http_alnum( c );
+         }
+      }
+
+      inline bool http_hex( const char c )
+      {
+         return ( ( c >= '0' ) && ( c <= '9' ) ) || ( ( ( c | 0x20 ) >= 'a' ) && ( ( c | 0x20 ) <= 'f' ) );
+      }
+
+      // VCHAR, obs_text and WSP.
+
+      inline bool http_text( const char c )
+      {
+         return ( ( c >= ' ' ) && ( c != 0x7f ) ) || ( c == '\t' ) || ( c & 0x80 );
+      }
+
+      inline std::uint64_t http_alnum_mask( const std::uint64_t v )
+      {
+         return swar_in_range< '0', '9' >( v ) | swar_in_range< 'a', 'z' >( v | swar_broadcast( 0x20 ) );
+      }
+
+      // Returns the end of the token at p.
+
+      inline const char * http_scan_token( const char * p, const char * const end )
+      {
+         for ( ;; ) {
+            while ( end - p >= 8 ) {
+               const std::uint64_t v = swar_load( p );
+               const std::uint64_t m = http_alnum_mask( v ) | swar_equal< '-' >( v );
+               if ( m != swar_broadcast( 0x80 ) ) {
+                  p += swar_count_leading( m );
+                  break;
+               }
+               p += 8;
+            }
+            if ( ( p == end ) || ! http_tchar( * p ) ) {
+               return p;
+            }
+            ++p;
+         }
+      }
+
+      // Returns the end of the path and query of an origin-form request
+      // target at p; stops at a '%' that is not followed by two hex digits.
+
+      inline const char * http_scan_path( const char * p, const char * const end )
+      {
+         for ( ;; ) {
+            while ( end - p >= 8 ) {
+               const std::uint64_t v = swar_load( p );
+               const std::uint64_t m = http_alnum_mask( v ) | swar_in_range< '-', '/' >( v );
+               if ( m != swar_broadcast( 0x80 ) ) {
+                  p += swar_count_leading( m );
+                  break;
+               }
+               p += 8;
+            }
+            if ( p == end ) {
+               return p;
+            }
+            if ( * p == '%' ) {
+               if ( ( end - p < 3 ) || ! http_hex( p[ 1 ] ) || ! http_hex( p[ 2 ] ) ) {
+                  return p;
+               }
+               p += 3;
+            }
+            else if ( http_path_char( * p ) ) {
+               ++p;
+            }
+            else {
+               return p;
+            }
+         }
+      }
+
+      // Returns the end of the text at p.
+
+      inline const char * http_scan_text( const char * p, const char * const end )
+      {
+         while ( end - p >= 8 ) {
+            const std::uint64_t v = swar_load( p );
+            const std::uint64_t m = swar_in_range< ' ', '~' >( v ) | ( v & swar_broadcast( 0x80 ) ) | swar_equal< '\t' >( v );
+            if ( m != swar_broadcast( 0x80 ) ) {
+               return p + swar_count_leading( m );
+            }
+            p += 8;
+         }
+         while ( ( p != end ) && http_text( * p ) ) {
+            ++p;
+         }
+         return p;
+      }
+
+      // Matches a fixed pattern in which every '0' stands for a digit.
+
+      template< std::size_t N >
+      http::parse_status http_pattern( const char * & p, const char * const end, const char( & pattern )[ N ] )
+      {
+         for ( std::size_t i = 0; i + 1 < N; ++i ) {
+            if ( p + i == end ) {
+               return http::parse_status::INCOMPLETE;
+            }
+            const char c = p[ i ];
+            if ( ( pattern[ i ] == '0' ) ? ( ( c < '0' ) || ( c > '9' ) ) : ( c != pattern[ i ] ) ) {
+               return http::parse_status::INVALID;
+            }
+         }
+         p += N - 1;
+         return http::parse_status::COMPLETE;
+      }
+
+      // The rare other forms of request targets are checked with the grammar.
+
+      inline bool http_other_target( const char * begin, const char * end )
+      {
+         try {
+            return parse_memory< seq< http::request_target, eof > >( begin, end, "http" );
+         }
+         catch ( const parse_error & ) {
+            return false;
+         }
+      }
+
+      template< std::size_t Capacity >
+      http::parse_status http_parse_start( const char * & p, const char * const end, http::request< Capacity > & m )
+      {
+         const char * t = http_scan_token( p, end );
+         if ( t == end ) {
+            return http::parse_status::INCOMPLETE;
+         }
+         if ( ( t == p ) || ( * t != ' ' ) ) {
+            return http::parse_status::INVALID;
+         }
+         m.method = view( p, std::size_t( t - p ) );
+         p = t + 1;
+         if ( p == end ) {
+            return http::parse_status::INCOMPLETE;
+         }
+         if ( * p == '/' ) {
+            t = http_scan_path( p + 1, end );
+            if ( ( t == end ) || ( ( * t == '%' ) && ( end - t < 3 ) ) ) {
+               return http::parse_status::INCOMPLETE;
+            }
+         }
+         else {
+            t = p;
+            while ( ( t != end ) && ( static_cast< unsigned char >( * t ) > ' ' ) ) {
+               ++t;
+            }
+            if ( t == end ) {
+               return http::parse_status::INCOMPLETE;
+            }
+            if ( ! http_other_target( p, t ) ) {
+               return http::parse_status::INVALID;
+            }
+         }
+         m.target = view( p, std::size_t( t - p ) );
+         p = t;
+         const char * const v = p;
+         const http::parse_status s = http_pattern( p, end, " HTTP/0.0\r\n" );
+         if ( s == http::parse_status::COMPLETE ) {
+            m.major_version = v[ 6 ] - '0';
+            m.minor_version = v[ 8 ] - '0';
+         }
+         return s;
+      }
+
+      template< std::size_t Capacity >
+      http::parse_status http_parse_start( const char * & p, const char * const end, http::response< Capacity > & m )
+      {
+         const char * const v = p;
+         const http::parse_status s = http_pattern( p, end, "HTTP/0.0 000 " );
+         if ( s != http::parse_status::COMPLETE ) {
+            return s;
+         }
+         m.major_version = v[ 5 ] - '0';
+         m.minor_version = v[ 7 ] - '0';
+         m.status = ( v[ 9 ] - '0' ) * 100 + ( v[ 10 ] - '0' ) * 10 + ( v[ 11 ] - '0' );
+         const char * t = http_scan_text( p, end );
+         m.reason = view( p, std::size_t( t - p ) );
+         p = t;
+         return http_pattern( p, end, "\r\n" );
+      }
+
+      // Header values can be continued on the next line with obs_fold, but
+      // only directly behind a visible character or another obs_fold, just
+      // like with http::header_field; the value excludes the optional
+      // whitespace around it.
+
+      template< typename Message >
+      http::parse_status http_parse_headers( const char * & p, const char * const end, Message & m )
+      {
+         for ( ;; ) {
+            if ( p == end ) {
+               return http::parse_status::INCOMPLETE;
+            }
+            if ( * p == '\r' ) {
+               return http_pattern( p, end, "\r\n" );
+            }
+            const char * t = http_scan_token( p, end );
+            if ( t == end ) {
+               return http::parse_status::INCOMPLETE;
+            }
+            if ( ( t == p ) || ( * t != ':' ) ) {
+               return http::parse_status::INVALID;
+            }
+            m.add_name( view( p, std::size_t( t - p ) ) );
+            if ( m.overflow ) {
+               return http::parse_status::INVALID;
+            }
+            p = t + 1;
+            while ( ( p != end ) && ( ( * p == ' ' ) || ( * p == '\t' ) ) ) {
+               ++p;
+            }
+            const char * const b = p;
+            for ( ;; ) {
+               t = http_scan_text( p, end );
+               const char * e = t;
+               while ( ( e != p ) && ( ( e[ -1 ] == ' ' ) || ( e[ -1 ] == '\t' ) ) ) {
+                  --e;
+               }
+               if ( end - t < 3 ) {
+                  return ( ( t == end ) || ( ( * t == '\r' ) && ( ( end - t < 2 ) || ( t[ 1 ] == '\n' ) ) ) ) ? http::parse_status::INCOMPLETE : http::parse_status::INVALID;
+               }
+               if ( ( t[ 0 ] != '\r' ) || ( t[ 1 ] != '\n' ) ) {
+                  return http::parse_status::INVALID;
+               }
+               if ( ( t[ 2 ] != ' ' ) && ( t[ 2 ] != '\t' ) ) {
+                  m.set_value( view( b, std::size_t( e - b ) ) );
+                  p = t + 2;
+                  break;
+               }
+               if ( e != t ) {
+                  return http::parse_status::INVALID;
+               }
+               p = t + 3;
+               while ( ( p != end ) && ( ( * p == ' ' ) || ( * p == '\t' ) ) ) {
+                  ++p;
+               }
+            }
+         }
+      }
+
+      // Empty lines before the start line are skipped, see RFC 7230, section 3.5.
+      // When called again for a longer input, the input is only parsed again
+      // once it contains the end of the head.
+
+      template< typename Message >
+      http::parse_status http_parse_head( const char * data, const std::size_t size, Message & m, std::size_t & consumed, const std::size_t checked )
+      {
+         std::size_t skip = 0;
+         while ( ( size - skip >= 2 ) && ( data[ skip ] == '\r' ) && ( data[ skip + 1 ] == '\n' ) ) {
+            skip += 2;
+         }
+         if ( ( size - skip == 1 ) && ( data[ skip ] == '\r' ) ) {
+            return http::parse_status::INCOMPLETE;
+         }
+         if ( checked ) {
+            const std::size_t start = std::max( skip, ( checked > 3 ) ? ( checked - 3 ) : 0 );
+            if ( ! http_head_end( data + skip, size - skip, start - skip ) ) {
+               return http::parse_status::INCOMPLETE;
+            }
+         }
+         m.clear();
+         const char * p = data + skip;
+         const char * const end = data + size;
+         http::parse_status s = http_parse_start( p, end, m );
+         if ( s == http::parse_status::COMPLETE ) {
+            s = http_parse_headers( p, end, m );
+         }
+         if ( s == http::parse_status::COMPLETE ) {
+            consumed = std::size_t( p - data );
+         }
+         return s;
+      }
+
+   } // internal
+
+   namespace http
+   {
+      // Parses the head of the request at the beginning of data, i.e. the
+      // request line and the headers, and sets consumed to its size on
+      // success; the body, if any, and further pipelined messages follow.
+      // When the head is incomplete the function can be called again with
+      // more data, passing the previous size as checked in order to not
+      // parse it again before the end of the head was received. The caller
+      // has to limit the size of the head, as INCOMPLETE is returned for as
+      // long as the input could be the beginning of a valid head.
+
+      template< std::size_t Capacity >
+      parse_status parse_request( const char * data, const std::size_t size, request< Capacity > & r, std::size_t & consumed, const std::size_t checked = 0 )
+      {
+         return internal::http_parse_head( data, size, r, consumed, checked );
+      }
+
+      template< std::size_t Capacity >
+      parse_status parse_response( const char * data, const std::size_t size, response< Capacity > & r, std::size_t & consumed, const std::size_t checked = 0 )
+      {
+         return internal::http_parse_head( data, size, r, consumed, checked );
+      }
+
+      // Incremental decoder for bodies with the chunked transfer coding; the
+      // chunk data is passed as views of the input, possibly split into
+      // several parts when the input ends within a chunk. The trailer is
+      // validated and skipped.
+
+      class chunked_decoder
+      {
+      public:
+         // Decodes as much of data as possible, calls f( view ) for all
+         // chunk data, and sets consumed to the size of the processed input.
+         // Returns COMPLETE after the end of the chunked body, and INCOMPLETE
+         // when more data is needed, in which case the decoder has to be
+         // called again with the input from data + consumed onwards.
+
+         template< typename F >
+         parse_status decode( const char * data, const std::size_t size, std::size_t & consumed, const F & f )
+         {
+            const char * p = data;
+            const char * const end = data + size;
+            const parse_status s = decode_impl( p, end, f );
+            consumed = std::size_t( p - data );
+            return s;
+         }
+
+         bool complete() const
+         {
+            return m_state == state::DONE;
+         }
+
+      private:
+         enum class state : char
+         {
+            SIZE,
+            DATA,
+            DATA_END,
+            TRAILER,
+            DONE
+         };
+
+         state m_state = state::SIZE;
+         std::size_t m_remaining = 0;
+
+         template< typename Line >
+         static parse_status line( const char * & p, const char * const end, std::size_t & size )
+         {
+            const char * n = static_cast< const char * >( std::memchr( p, '\n', std::size_t( end - p ) ) );
+            if ( ! n ) {
+               return parse_status::INCOMPLETE;
+            }
+            try {
+               if ( ! parse_memory< Line, chunk_action >( p, n + 1, "http", size ) ) {
+                  return parse_status::INVALID;
+               }
+            }
+            catch ( const parse_error & ) {
+               return parse_status::INVALID;
+            }
+            p = n + 1;
+            return parse_status::COMPLETE;
+         }
+
+         template< typename F >
+         parse_status decode_impl( const char * & p, const char * const end, const F & f )
+         {
+            while ( p != end ) {
+               switch ( m_state ) {
+                  case state::SIZE: {
+                     const parse_status s = line< chunk_line >( p, end, m_remaining );
+                     if ( s != parse_status::COMPLETE ) {
+                        return s;
+                     }
+                     m_state = m_remaining ? state::DATA : state::TRAILER;
+                  } break;
+                  case state::DATA: {
+                     const std::size_t n = std::min( m_remaining, std::size_t( end - p ) );
+                     f( view( p, n ) );
+                     p += n;
+                     m_remaining -= n;
+                     if ( ! m_remaining ) {
+                        m_state = state::DATA_END;
+                     }
+                  } break;
+                  case state::DATA_END:
+                     if ( end - p < 2 ) {
+                        return ( * p == '\r' ) ? parse_status::INCOMPLETE : parse_status::INVALID;
+                     }
+                     if ( ( p[ 0 ] != '\r' ) || ( p[ 1 ] != '\n' ) ) {
+                        return parse_status::INVALID;
+                     }
+                     p += 2;
+                     m_state = state::SIZE;
+                     break;
+                  case state::TRAILER: {
+                     if ( * p == '\r' ) {
+                        if ( end - p < 2 ) {
+                           return parse_status::INCOMPLETE;
+                        }
+                        if ( p[ 1 ] != '\n' ) {
+                           return parse_status::INVALID;
+                        }
+                        p += 2;
+                        m_state = state::DONE;
+                        return parse_status::COMPLETE;
+                     }
+                     std::size_t dummy = 0;
+                     const parse_status s = line< trailer_line >( p, end, dummy );
+                     if ( s != parse_status::COMPLETE ) {
+                        return s;
+                     }
+                  } break;
+                  case state::DONE:
+                     return parse_status::COMPLETE;
+               }
+            }
+            return ( m_state == state::DONE ) ? parse_status::COMPLETE : parse_status::INCOMPLETE;
+         }
+      };
+
+   } // http
+
+} // pegtl
+
+#endif
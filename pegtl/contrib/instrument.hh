@@ -0,0 +1,404 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_INSTRUMENT_HH
+#define PEGTL_CONTRIB_INSTRUMENT_HH
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstddef>
+#include <ostream>
+#include <algorithm>
+
+#include "../normal.hh"
+#include "../apply_mode.hh"
+
+#include "../internal/skip_control.hh"
+
+#include "rule_id.hh"
+#include "profiler.hh"
+#include "binary_trace.hh"
+
+namespace pegtl
+{
+   namespace instrument
+   {
+      // Base class for the receivers of the events of the instrumented
+      // control class; rule is the internal::rule_id of the rule, and
+      // begin, line and byte_in_line give the current input position.
+      // When a match is aborted by an exception, unwind() is called for
+      // the rule instead of success() or failure().
+
+      class sink
+      {
+      public:
+         virtual ~sink() = default;
+
+         virtual void start( const std::size_t /*rule*/, const char * /*begin*/, const std::size_t /*line*/, const std::size_t /*byte_in_line*/ ) {}
+         virtual void success( const std::size_t /*rule*/, const char * /*begin*/, const std::size_t /*line*/, const std::size_t /*byte_in_line*/ ) {}
+         virtual void failure( const std::size_t /*rule*/, const char * /*begin*/, const std::size_t /*line*/, const std::size_t /*byte_in_line*/ ) {}
+         virtual void raise( const std::size_t /*rule*/, const char * /*begin*/, const std::size_t /*line*/, const std::size_t /*byte_in_line*/ ) {}
+         virtual void unwind( const std::size_t /*rule*/ ) {}
+      };
+
+      // Global set of sinks and the switch that enables them; the switch can
+      // be flipped at any time, e.g. from another thread, but sinks must only
+      // be added or removed while no instrumented parsing is in progress.
+      // The sinks are called from all threads that parse with instrumented.
+
+      class registry
+      {
+      public:
+         static void add( sink & s )
+         {
+            sinks().push_back( & s );
+            update();
+         }
+
+         static void remove( sink & s )
+         {
+            auto & v = sinks();
+            v.erase( std::remove( v.begin(), v.end(), & s ), v.end() );
+            update();
+         }
+
+         static void enable( const bool e = true )
+         {
+            enabled() = e;
+            update();
+         }
+
+         static bool active()
+         {
+            return flag().load( std::memory_order_relaxed );
+         }
+
+         static const std::vector< sink * > & all()
+         {
+            return sinks();
+         }
+
+         // Shared by all rules, instead of being inlined into every match, to keep
+         // the code of the instrumented control class close to that of normal.
+
+         static void dispatch( const trace_event e, const std::size_t rule, const char * begin, const std::size_t line, const std::size_t byte_in_line )
+         {
+            for ( auto * s : sinks() ) {
+               switch ( e ) {
+                  case trace_event::START:
+                     s->start( rule, begin, line, byte_in_line );
+                     break;
+                  case trace_event::SUCCESS:
+                     s->success( rule, begin, line, byte_in_line );
+                     break;
+                  case trace_event::FAILURE:
+                     s->failure( rule, begin, line, byte_in_line );
+                     break;
+                  case trace_event::RAISE:
+                     s->raise( rule, begin, line, byte_in_line );
+                     break;
+               }
+            }
+         }
+
+         static void unwind( const std::size_t rule )
+         {
+            for ( auto * s : sinks() ) {
+               s->unwind( rule );
+            }
+         }
+
+      private:
+         static std::vector< sink * > & sinks()
+         {
+            static std::vector< sink * > s;
+            return s;
+         }
+
+         static std::atomic< bool > & enabled()
+         {
+            static std::atomic< bool > e( false );
+            return e;
+         }
+
+         static std::atomic< bool > & flag()
+         {
+            static std::atomic< bool > f( false );
+            return f;
+         }
+
+         static void update()
+         {
+            flag().store( enabled() && ! sinks().empty(), std::memory_order_relaxed );
+         }
+      };
+
+      // Sink that prints the events like the tracer.
+
+      class ostream_sink
+            : public sink
+      {
+      public:
+         explicit
+         ostream_sink( std::ostream & o )
+               : m_ostream( o )
+         { }
+
+         void start( const std::size_t rule, const char *, const std::size_t line, const std::size_t byte_in_line ) override
+         {
+            print( "  start ", rule, line, byte_in_line );
+         }
+
+         void success( const std::size_t rule, const char *, const std::size_t line, const std::size_t byte_in_line ) override
+         {
+            print( " success ", rule, line, byte_in_line );
+         }
+
+         void failure( const std::size_t rule, const char *, const std::size_t line, const std::size_t byte_in_line ) override
+         {
+            print( " failure ", rule, line, byte_in_line );
+         }
+
+      private:
+         std::ostream & m_ostream;
+
+         void print( const char * event, const std::size_t rule, const std::size_t line, const std::size_t byte_in_line )
+         {
+            m_ostream << line << ':' << byte_in_line << event << internal::rule_registry::name( rule ) << '\n';
+         }
+      };
+
+      // Sink that records the events in the binary_trace of the current thread.
+
+      class binary_trace_sink
+            : public sink
+      {
+      public:
+         void start( const std::size_t rule, const char *, const std::size_t line, const std::size_t byte_in_line ) override
+         {
+            binary_trace::record( rule, trace_event::START, line, byte_in_line );
+         }
+
+         void success( const std::size_t rule, const char *, const std::size_t line, const std::size_t byte_in_line ) override
+         {
+            binary_trace::record( rule, trace_event::SUCCESS, line, byte_in_line );
+         }
+
+         void failure( const std::size_t rule, const char *, const std::size_t line, const std::size_t byte_in_line ) override
+         {
+            binary_trace::record( rule, trace_event::FAILURE, line, byte_in_line );
+         }
+
+         void raise( const std::size_t rule, const char *, const std::size_t line, const std::size_t byte_in_line ) override
+         {
+            binary_trace::record( rule, trace_event::RAISE, line, byte_in_line );
+         }
+      };
+
+      // Sink that counts the events per rule, e.g. to determine which rules of
+      // a grammar are covered by a set of inputs; not synchronised, i.e. only
+      // for use with one parsing thread.
+
+      class coverage_sink
+            : public sink
+      {
+      public:
+         struct entry
+         {
+            std::size_t start = 0;
+            std::size_t success = 0;
+            std::size_t failure = 0;
+            std::size_t raise = 0;
+         };
+
+         const std::vector< entry > & entries() const
+         {
+            return m_entries;
+         }
+
+         void start( const std::size_t rule, const char *, const std::size_t, const std::size_t ) override
+         {
+            ++get( rule ).start;
+         }
+
+         void success( const std::size_t rule, const char *, const std::size_t, const std::size_t ) override
+         {
+            ++get( rule ).success;
+         }
+
+         void failure( const std::size_t rule, const char *, const std::size_t, const std::size_t ) override
+         {
+            ++get( rule ).failure;
+         }
+
+         void raise( const std::size_t rule, const char *, const std::size_t, const std::size_t ) override
+         {
+            ++get( rule ).raise;
+         }
+
+      private:
+         std::vector< entry > m_entries;
+
+         entry & get( const std::size_t rule )
+         {
+            if ( rule >= m_entries.size() ) {
+               m_entries.resize( internal::rule_registry::size() );
+            }
+            return m_entries[ rule ];
+         }
+      };
+
+      // Sink that collects the same per-rule data as the profiler control
+      // class in a table of its own, which can be printed with report(); with
+      // timed the (inclusive) time per rule is measured like with the
+      // timed_profiler. Not synchronised, i.e. only for use with one parsing
+      // thread at a time.
+
+      class profile_sink
+            : public sink
+      {
+      public:
+         explicit
+         profile_sink( const bool timed = false )
+               : m_timed( timed )
+         { }
+
+         const std::vector< profile_entry > & entries() const
+         {
+            return m_entries;
+         }
+
+         const profile_entry & entry( const std::size_t rule )
+         {
+            return get( rule );
+         }
+
+         void reset()
+         {
+            m_entries.assign( m_entries.size(), profile_entry() );
+         }
+
+         void report( std::ostream & o ) const
+         {
+            profile::report( o, m_entries, buffer_stats() );
+         }
+
+         void start( const std::size_t rule, const char * begin, const std::size_t, const std::size_t ) override
+         {
+            ++get( rule ).start;
+            m_stack.push_back( open{ begin, m_timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point() } );
+         }
+
+         void success( const std::size_t rule, const char * begin, const std::size_t, const std::size_t ) override
+         {
+            auto & p = get( rule );
+            ++p.success;
+            p.bytes += begin - finish( p );
+         }
+
+         void failure( const std::size_t rule, const char *, const std::size_t, const std::size_t ) override
+         {
+            auto & p = get( rule );
+            ++p.failure;
+            finish( p );
+         }
+
+         void unwind( const std::size_t rule ) override
+         {
+            finish( get( rule ) );
+         }
+
+      private:
+         const bool m_timed;
+
+         // One frame per rule that was started and has not yet finished, i.e.
+         // the frame of the finishing rule is always the last one since every
+         // start() is paired with one success(), failure() or unwind().
+
+         struct open
+         {
+            const char * begin;
+            std::chrono::steady_clock::time_point time;
+         };
+
+         std::vector< open > m_stack;
+         std::vector< profile_entry > m_entries;
+
+         profile_entry & get( const std::size_t rule )
+         {
+            if ( rule >= m_entries.size() ) {
+               m_entries.resize( internal::rule_registry::size() );
+            }
+            return m_entries[ rule ];
+         }
+
+         // Returns where the rule started.
+
+         const char * finish( profile_entry & p )
+         {
+            const open o = m_stack.back();
+            m_stack.pop_back();
+            if ( m_timed ) {
+               p.nanoseconds += std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - o.time ).count();
+            }
+            return o.begin;
+         }
+      };
+
+   } // instrument
+
+   // Control class that passes all events to the registered sinks while
+   // instrumentation is enabled with instrument::registry::enable() and at
+   // least one sink was added, and to Base; otherwise it continues matching
+   // with Base as control class, i.e. when parsing while it is not enabled,
+   // the only cost is one check of a global flag at the start. Use e.g.
+   // instrumented<>::control or instrumented< my_control >::control.
+
+   template< template< typename ... > class Base = normal >
+   struct instrumented
+   {
+      template< typename Rule >
+      struct control
+            : Base< Rule >
+      {
+         // The events are dispatched around the match of Base instead of from
+         // its start(), success() and failure() so that every start is paired
+         // with exactly one success, failure or unwind, also when an action
+         // throws after the rule itself succeeded.
+
+         template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+         static bool match( Input & in, States && ... st )
+         {
+            if ( ! instrument::registry::active() ) {
+               return Base< Rule >::template match< A, Action, Base >( in, st ... );
+            }
+            if ( internal::skip_control< Rule >::value ) {
+               return Base< Rule >::template match< A, Action, Control >( in, st ... );
+            }
+            const std::size_t id = internal::rule_id< Rule >::value;
+            instrument::registry::dispatch( trace_event::START, id, in.begin(), in.line(), in.byte_in_line() );
+            bool result;
+            try {
+               result = Base< Rule >::template match< A, Action, Control >( in, st ... );
+            }
+            catch ( ... ) {
+               instrument::registry::unwind( id );
+               throw;
+            }
+            instrument::registry::dispatch( result ? trace_event::SUCCESS : trace_event::FAILURE, id, in.begin(), in.line(), in.byte_in_line() );
+            return result;
+         }
+
+         template< typename Input, typename ... States >
+         static void raise( const Input & in, States && ... st )
+         {
+            instrument::registry::dispatch( trace_event::RAISE, internal::rule_id< Rule >::value, in.begin(), in.line(), in.byte_in_line() );
+            Base< Rule >::raise( in, st ... );
+         }
+      };
+   };
+
+} // pegtl
+
+#endif
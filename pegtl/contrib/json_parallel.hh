@@ -0,0 +1,198 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_JSON_PARALLEL_HH
+#define PEGTL_CONTRIB_JSON_PARALLEL_HH
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "../parse.hh"
+#include "../normal.hh"
+#include "../nothing.hh"
+#include "../memory_input.hh"
+
+#include "../internal/swar.hh"
+
+#include "json.hh"
+#include "parallel.hh"
+
+namespace pegtl
+{
+   namespace internal
+   {
+      struct json_chunk
+      {
+         const char * begin;
+         const char * end;
+         std::size_t line;
+         std::size_t byte_in_line;
+      };
+
+      inline bool json_structural( const std::uint64_t v )
+      {
+         return swar_has_byte< '"' >( v ) || swar_has_byte< ',' >( v ) || swar_has_byte< '\n' >( v ) || swar_has_byte< '[' >( v ) || swar_has_byte< ']' >( v ) || swar_has_byte< '{' >( v ) || swar_has_byte< '}' >( v );
+      }
+
+      inline bool json_string_special( const std::uint64_t v )
+      {
+         return swar_has_byte< '"' >( v ) || swar_has_byte< '\\' >( v ) || swar_has_less< 0x20 >( v );
+      }
+
+      // Builds an index of the top-level JSON array in [ p, end ) by splitting
+      // its content at top-level value separators into chunks of at least size
+      // bytes, excluding the separators between the chunks. Skips
+      // strings, escape sequences and nested values eight bytes at a time where
+      // possible. Returns false when the input is not (structurally) a single
+      // array; the content of the chunks is not validated.
+
+      inline bool json_array_index( const char * p, const char * const end, std::size_t line, const std::size_t byte_in_line, const std::size_t size, std::vector< json_chunk > & result )
+      {
+         const char * line_begin = p;
+         std::size_t line_offset = byte_in_line;
+
+         const auto next_line = [ & ]( const char * q )
+            {
+               ++line;
+               line_begin = q + 1;
+               line_offset = 0;
+            };
+         const auto chunk = [ & ]( const char * q )
+            {
+               result.push_back( json_chunk{ q, q, line, line_offset + std::size_t( q - line_begin ) } );
+            };
+
+         for ( ; ( p != end ) && ( ( * p == ' ' ) || ( * p == '\t' ) || ( * p == '\r' ) || ( * p == '\n' ) ); ++p ) {
+            if ( * p == '\n' ) {
+               next_line( p );
+            }
+         }
+         if ( ( p == end ) || ( * p != '[' ) ) {
+            return false;
+         }
+         chunk( ++p );
+         std::size_t depth = 1;
+
+         while ( p != end ) {
+            while ( ( end - p >= 8 ) && ! json_structural( swar_load( p ) ) ) {
+               p += 8;
+            }
+            if ( p == end ) {
+               break;
+            }
+            switch ( * p ) {
+               case '"':
+                  for ( ++p; ; ) {
+                     while ( ( end - p >= 8 ) && ! json_string_special( swar_load( p ) ) ) {
+                        p += 8;
+                     }
+                     if ( p == end ) {
+                        return false;
+                     }
+                     if ( * p == '"' ) {
+                        break;
+                     }
+                     if ( * p == '\\' ) {
+                        if ( ++p == end ) {
+                           return false;
+                        }
+                     }
+                     if ( * p == '\n' ) {
+                        next_line( p );
+                     }
+                     ++p;
+                  }
+                  break;
+               case '[':
+               case '{':
+                  ++depth;
+                  break;
+               case ']':
+               case '}':
+                  if ( --depth == 0 ) {
+                     if ( * p != ']' ) {
+                        return false;
+                     }
+                     result.back().end = p;
+                     for ( ++p; ( p != end ) && ( ( * p == ' ' ) || ( * p == '\t' ) || ( * p == '\r' ) || ( * p == '\n' ) ); ++p ) {
+                     }
+                     return p == end;
+                  }
+                  break;
+               case ',':
+                  if ( ( depth == 1 ) && ( std::size_t( p - result.back().begin ) >= size ) ) {
+                     result.back().end = p;
+                     chunk( p + 1 );
+                  }
+                  break;
+               case '\n':
+                  next_line( p );
+                  break;
+            }
+            ++p;
+         }
+         return false;
+      }
+
+   } // internal
+
+   namespace json
+   {
+      // A chunk of the content of a top-level array consisting of one or more complete array elements.
+
+      struct array_chunk : must< star< ws >, list_must< array_element, value_separator >, eof > {};
+
+      // Parses the input, which is expected to be a single JSON text with a
+      // (large) array as top-level value, by parsing groups of consecutive
+      // array elements of approximately chunk_size bytes in parallel on up to
+      // threads threads (0 for the number of hardware threads). Every chunk is
+      // parsed as separate memory_input, with correct line numbers and byte
+      // offsets for errors, with its own default-constructed State. The states
+      // are combined into st with reduce( st, std::move( state ) ) in the
+      // order of the chunks. The actions for the rules of the top-level array
+      // itself, e.g. for json::array::begin, are not called. When the input
+      // is not a top-level array it is parsed sequentially with json::text.
+      // Global errors are raised as parse_error, for the first chunk with an
+      // error, as when parsing sequentially.
+
+      template< template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename State, typename Reduce >
+      bool parse_array_parallel( const memory_input & in, State & st, const Reduce & reduce, const std::size_t threads = 0, const std::size_t chunk_size = 1 << 20 )
+      {
+         std::vector< internal::json_chunk > chunks;
+
+         if ( ! internal::json_array_index( in.begin(), in.end( 0 ), in.line(), in.byte_in_line(), chunk_size, chunks ) ) {
+            State s;
+            memory_input si( in.line(), in.byte_in_line(), in.begin(), in.end( 0 ), in.source() );
+            const bool result = parse_input< must< text, eof >, Action, Control >( si, s );
+            reduce( st, std::move( s ) );
+            return result;
+         }
+         const std::size_t count = chunks.size();
+
+         if ( count == 1 ) {
+            memory_input ei( chunks[ 0 ].line, chunks[ 0 ].byte_in_line, chunks[ 0 ].begin, chunks[ 0 ].end, in.source() );
+            if ( parse_input< seq< star< ws >, eof > >( ei ) ) {
+               return true;  // Empty array.
+            }
+         }
+         std::vector< State > states( count );
+
+         internal::parallel_for( count, internal::parallel_threads( threads, count ), [ & ]( const std::size_t i, const std::size_t )
+            {
+               memory_input ci( chunks[ i ].line, chunks[ i ].byte_in_line, chunks[ i ].begin, chunks[ i ].end, in.source() );
+               parse_input< array_chunk, Action, Control >( ci, states[ i ] );
+            } );
+
+         for ( auto & s : states ) {
+            reduce( st, std::move( s ) );
+         }
+         return true;
+      }
+
+   } // json
+
+} // pegtl
+
+#endif
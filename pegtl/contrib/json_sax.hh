@@ -0,0 +1,178 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_JSON_SAX_HH
+#define PEGTL_CONTRIB_JSON_SAX_HH
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+
+#include "../nothing.hh"
+
+#include "json.hh"
+#include "unescape.hh"
+
+namespace pegtl
+{
+   namespace json
+   {
+      // Consumer base class with empty event functions; a consumer can
+      // derive from this class and only define the events it is
+      // interested in. String and key data is only valid during the call.
+
+      struct sax_base
+      {
+         void null() {}
+         void boolean( const bool ) {}
+         void number( const char *, const std::size_t ) {}
+         void string( const char *, const std::size_t ) {}
+         void key( const char *, const std::size_t ) {}
+         void begin_array() {}
+         void end_array() {}
+         void begin_object() {}
+         void end_object() {}
+      };
+
+      // State class that is passed to the sax_action; holds a reference
+      // to the user's consumer, and a buffer that is re-used for strings
+      // and keys that contain escape sequences.
+
+      template< typename Consumer >
+      struct sax_state
+      {
+         explicit
+         sax_state( Consumer & in_consumer )
+               : consumer( in_consumer )
+         { }
+
+         sax_state( const sax_state & ) = delete;
+         void operator= ( const sax_state & ) = delete;
+
+         Consumer & consumer;
+         std::string unescaped;
+
+         template< typename Input, typename F >
+         void content( const Input & in, const F & f )
+         {
+            if ( ! std::memchr( in.begin(), '\\', in.size() ) ) {
+               f( in.begin(), in.size() );
+            }
+            else {
+               unescaped.clear();
+               unescape::unescape_json_content( in.begin(), in.end(), unescaped );
+               f( unescaped.data(), unescaped.size() );
+            }
+         }
+      };
+
+      // Action class that calls the event functions of the consumer for
+      // the JSON grammar, use with a sax_state< Consumer > as only state.
+
+      template< typename Rule > struct sax_action : nothing< Rule > {};
+
+      template<>
+      struct sax_action< null >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input &, State & st )
+         {
+            st.consumer.null();
+         }
+      };
+
+      template<>
+      struct sax_action< true_ >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input &, State & st )
+         {
+            st.consumer.boolean( true );
+         }
+      };
+
+      template<>
+      struct sax_action< false_ >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input &, State & st )
+         {
+            st.consumer.boolean( false );
+         }
+      };
+
+      template<>
+      struct sax_action< number >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input & in, State & st )
+         {
+            st.consumer.number( in.begin(), in.size() );
+         }
+      };
+
+      template<>
+      struct sax_action< string::content >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input & in, State & st )
+         {
+            st.content( in, [ & ]( const char * b, const std::size_t s ){ st.consumer.string( b, s ); } );
+         }
+      };
+
+      template<>
+      struct sax_action< key::content >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input & in, State & st )
+         {
+            st.content( in, [ & ]( const char * b, const std::size_t s ){ st.consumer.key( b, s ); } );
+         }
+      };
+
+      template<>
+      struct sax_action< array::begin >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input &, State & st )
+         {
+            st.consumer.begin_array();
+         }
+      };
+
+      template<>
+      struct sax_action< array::end >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input &, State & st )
+         {
+            st.consumer.end_array();
+         }
+      };
+
+      template<>
+      struct sax_action< object::begin >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input &, State & st )
+         {
+            st.consumer.begin_object();
+         }
+      };
+
+      template<>
+      struct sax_action< object::end >
+      {
+         template< typename Input, typename State >
+         static void apply( const Input &, State & st )
+         {
+            st.consumer.end_object();
+         }
+      };
+
+   } // json
+
+} // pegtl
+
+#endif
@@ -0,0 +1,231 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_PARALLEL_HH
+#define PEGTL_CONTRIB_PARALLEL_HH
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <exception>
+
+#include "../parse.hh"
+#include "../normal.hh"
+#include "../nothing.hh"
+#include "../input_error.hh"
+#include "../memory_input.hh"
+
+#include "../internal/file_reader.hh"
+
+namespace pegtl
+{
+   namespace internal
+   {
+      inline std::size_t parallel_threads( const std::size_t threads, const std::size_t count )
+      {
+         const std::size_t t = threads ? threads : std::max( std::size_t( std::thread::hardware_concurrency() ), std::size_t( 1 ) );
+         return std::max( std::min( t, count ), std::size_t( 1 ) );
+      }
+
+      // Calls f( index, worker ) for every index in [ 0, count ) on up to
+      // threads threads, where worker is the number of the calling thread
+      // in [ 0, threads ). Idle threads take the next index from a shared
+      // counter so that the load is balanced dynamically. The calling thread
+      // is worker 0. When f() throws for one or more indices, the exception
+      // for the lowest index is rethrown after all threads have finished.
+      // When starting a thread throws, the threads that were already started
+      // are stopped after their current index and joined before rethrowing.
+
+      template< typename F >
+      void parallel_for( const std::size_t count, const std::size_t threads, const F & f )
+      {
+         std::atomic< std::size_t > next( 0 );
+         std::vector< std::exception_ptr > errors( count );
+
+         const auto work = [ & ]( const std::size_t worker )
+            {
+               for ( std::size_t i = next++; i < count; i = next++ ) {
+                  try {
+                     f( i, worker );
+                  }
+                  catch ( ... ) {
+                     errors[ i ] = std::current_exception();
+                  }
+               }
+            };
+
+         std::vector< std::thread > pool;
+         try {
+            for ( std::size_t t = 1; t < threads; ++t ) {
+               pool.emplace_back( work, t );
+            }
+         }
+         catch ( ... ) {
+            next = count;
+            for ( auto & t : pool ) {
+               t.join();
+            }
+            throw;
+         }
+         work( 0 );
+
+         for ( auto & t : pool ) {
+            t.join();
+         }
+         for ( const auto & e : errors ) {
+            if ( e ) {
+               std::rethrow_exception( e );
+            }
+         }
+      }
+
+      // Splits [ begin, end ) into chunks of approximately size bytes each;
+      // every chunk except the last ends immediately after a line feed. An
+      // empty range yields one empty chunk.
+
+      inline std::vector< const char * > split_lines( const char * begin, const char * const end, const std::size_t size )
+      {
+         std::vector< const char * > result( 1, begin );
+
+         while ( std::size_t( end - begin ) > size ) {
+            const auto * n = static_cast< const char * >( std::memchr( begin + size, '\n', end - begin - size ) );
+            if ( ! n ) {
+               break;
+            }
+            begin = n + 1;
+            result.push_back( begin );
+         }
+         if ( ( begin != end ) || ( result.size() == 1 ) ) {
+            result.push_back( end );
+         }
+         return result;
+      }
+
+   } // internal
+
+   // Parses the input, which is expected to consist of independent lines
+   // or records, in chunks that are split at line feeds, in parallel on up to
+   // threads threads (0 for the number of hardware threads). Every chunk is
+   // parsed as separate memory_input, with correct line numbers, with Rule,
+   // which therefore has to match sequences of complete lines. Each thread
+   // uses its own, default-constructed, State, which are combined into st
+   // with reduce( st, std::move( state ) ) in the order of the threads, i.e.
+   // the order of the chunks is not preserved in the reduction. Returns
+   // true iff all chunks were matched successfully by Rule; an empty input
+   // is one empty chunk. When parsing any chunk throws, the exception of
+   // the first such chunk is rethrown.
+
+   template< typename Rule, template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename State, typename Reduce >
+   bool parse_lines_parallel( const memory_input & in, State & st, const Reduce & reduce, const std::size_t threads = 0, const std::size_t chunk_size = 1 << 20 )
+   {
+      const auto chunks = internal::split_lines( in.begin(), in.end( 0 ), std::max( chunk_size, std::size_t( 1 ) ) );
+      const std::size_t count = chunks.size() - 1;
+      const std::size_t t = internal::parallel_threads( threads, count );
+
+      // The line feeds are counted in parallel too so that each chunk can start with the correct line number.
+
+      std::vector< std::size_t > lines( count + 1, in.line() );
+      internal::parallel_for( count, t, [ & ]( const std::size_t i, const std::size_t )
+         {
+            lines[ i + 1 ] = std::size_t( std::count( chunks[ i ], chunks[ i + 1 ], '\n' ) );
+         } );
+      for ( std::size_t i = 1; i < count; ++i ) {
+         lines[ i ] += lines[ i - 1 ];
+      }
+      std::vector< State > states( t );
+      std::atomic< bool > result( true );
+
+      internal::parallel_for( count, t, [ & ]( const std::size_t i, const std::size_t worker )
+         {
+            memory_input ci( lines[ i ], i ? 0 : in.byte_in_line(), chunks[ i ], chunks[ i + 1 ], in.source() );
+            if ( ! parse_input< Rule, Action, Control >( ci, states[ worker ] ) ) {
+               result = false;
+            }
+         } );
+
+      for ( auto & s : states ) {
+         reduce( st, std::move( s ) );
+      }
+      return result;
+   }
+
+   // The result of parsing one file with parse_files<>(): the return value
+   // of the parsing function, or, when parsing threw an exception, e.g. a
+   // parse_error or input_error, the exception.
+
+   struct file_result
+   {
+      bool success = false;
+      std::exception_ptr error;
+   };
+
+   // Parses the files in parallel on up to threads threads (0 for the number
+   // of hardware threads), starting with the largest files to reduce the time
+   // the last thread needs after all others have finished. Every thread uses
+   // one State, obtained from make_state(), for all files that it parses, and
+   // one buffer into which the files are read. The states are handed over to
+   // reduce( std::move( state ) ) in the calling thread after all files were
+   // parsed. Returns the results in the order of the paths; exceptions thrown
+   // while parsing a file are not propagated but stored in its result.
+
+   template< typename Rule, template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename MakeState, typename Reduce >
+   std::vector< file_result > parse_files( const std::vector< std::string > & paths, const MakeState & make_state, const Reduce & reduce, const std::size_t threads = 0 )
+   {
+      const std::size_t count = paths.size();
+      const std::size_t t = internal::parallel_threads( threads, count );
+
+      std::vector< std::size_t > sizes( count, 0 );
+      internal::parallel_for( count, t, [ & ]( const std::size_t i, const std::size_t )
+         {
+            try {
+               sizes[ i ] = internal::file_reader( paths[ i ] ).size();
+            }
+            catch ( const input_error & ) {
+               // Reported when parsing the file.
+            }
+         } );
+
+      std::vector< std::size_t > order( count );
+      for ( std::size_t i = 0; i < count; ++i ) {
+         order[ i ] = i;
+      }
+      std::stable_sort( order.begin(), order.end(), [ & ]( const std::size_t l, const std::size_t r ){ return sizes[ l ] > sizes[ r ]; } );
+
+      using State = decltype( make_state() );
+      std::vector< State > states;
+      states.reserve( t );
+      for ( std::size_t i = 0; i < t; ++i ) {
+         states.push_back( make_state() );
+      }
+      std::vector< std::string > buffers( t );
+      std::vector< file_result > results( count );
+
+      internal::parallel_for( count, t, [ & ]( const std::size_t i, const std::size_t worker )
+         {
+            const std::string & path = paths[ order[ i ] ];
+            file_result & r = results[ order[ i ] ];
+            try {
+               internal::file_reader( path ).read( buffers[ worker ] );
+               const std::string & b = buffers[ worker ];
+               memory_input in( 1, 0, b.data(), b.data() + b.size(), path.c_str() );
+               r.success = parse_input< Rule, Action, Control >( in, states[ worker ] );
+            }
+            catch ( ... ) {
+               r.error = std::current_exception();
+            }
+         } );
+
+      for ( auto & s : states ) {
+         reduce( std::move( s ) );
+      }
+      return results;
+   }
+
+} // pegtl
+
+#endif
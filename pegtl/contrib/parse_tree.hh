@@ -0,0 +1,327 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_PARSE_TREE_HH
+#define PEGTL_CONTRIB_PARSE_TREE_HH
+
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <typeinfo>
+#include <type_traits>
+
+#include "../parse.hh"
+#include "../rules.hh"
+#include "../normal.hh"
+#include "../nothing.hh"
+#include "../apply_mode.hh"
+
+#include "../internal/demangle.hh"
+
+namespace pegtl
+{
+   namespace parse_tree
+   {
+      // A node refers to the matched input by byte offsets relative to the
+      // beginning of the input, and to its children by a range of indices
+      // into the node vector of the tree; all children of a node are stored
+      // next to each other.
+
+      struct node
+      {
+         const std::type_info * id;
+         std::size_t begin;
+         std::size_t end;
+         std::size_t first;
+         std::size_t count;
+
+         template< typename Rule >
+         bool is() const
+         {
+            return * id == typeid( Rule );
+         }
+
+         std::string name() const
+         {
+            return internal::demangle( id->name() );
+         }
+
+         std::size_t size() const
+         {
+            return end - begin;
+         }
+      };
+
+      // The tree stores all nodes in a single vector in post-order, with
+      // the (artificial) root node that spans the whole match at the end.
+      // Nodes are built on a separate stack while their rule is matched;
+      // on success, the finished children of a node are appended to the
+      // node vector in one go. Every rule, selected or not, remembers the
+      // sizes of both vectors when it starts, so that all nodes built
+      // while a rule was attempted are dropped when it fails. A tree can
+      // be re-used for multiple parsing runs to retain its capacity.
+
+      class tree
+      {
+      public:
+         tree() = default;
+
+         tree( const tree & ) = delete;
+         void operator= ( const tree & ) = delete;
+
+         void reset( const char * base )
+         {
+            m_base = base;
+            m_nodes.clear();
+            m_pending.clear();
+            m_open.clear();
+         }
+
+         void reserve( const std::size_t count )
+         {
+            m_nodes.reserve( count );
+            m_pending.reserve( count );
+         }
+
+         bool empty() const
+         {
+            return m_nodes.empty();
+         }
+
+         const node & root() const
+         {
+            assert( ! m_nodes.empty() );
+            return m_nodes.back();
+         }
+
+         const std::vector< node > & nodes() const
+         {
+            return m_nodes;
+         }
+
+         const node * begin( const node & n ) const
+         {
+            return m_nodes.data() + n.first;
+         }
+
+         const node * end( const node & n ) const
+         {
+            return m_nodes.data() + n.first + n.count;
+         }
+
+         const char * base() const
+         {
+            return m_base;
+         }
+
+         std::string string( const node & n ) const
+         {
+            return std::string( m_base + n.begin, m_base + n.end );
+         }
+
+         void start( const char * at )
+         {
+            m_open.push_back( open{ std::size_t( at - m_base ), m_pending.size(), m_nodes.size() } );
+         }
+
+         template< typename Rule >
+         void success( const char * at )
+         {
+            assert( ! m_open.empty() );
+            const auto o = m_open.back();
+            m_open.pop_back();
+            m_pending.push_back( make< Rule >( o, std::size_t( at - m_base ) ) );
+         }
+
+         // Success of a rule without a node, its nodes are kept for the
+         // next selected ancestor.
+
+         void keep()
+         {
+            assert( ! m_open.empty() );
+            m_open.pop_back();
+         }
+
+         void failure()
+         {
+            assert( ! m_open.empty() );
+            m_pending.resize( m_open.back().pending );
+            m_nodes.resize( m_open.back().nodes );
+            m_open.pop_back();
+         }
+
+         // The sizes of the stacks, to restore them when an exception aborts
+         // rules that therefore never call success() or failure().
+
+         struct mark
+         {
+            std::size_t open;
+            std::size_t pending;
+            std::size_t nodes;
+         };
+
+         mark sizes() const
+         {
+            return mark{ m_open.size(), m_pending.size(), m_nodes.size() };
+         }
+
+         void restore( const mark & m )
+         {
+            m_open.resize( m.open );
+            m_pending.resize( m.pending );
+            m_nodes.resize( m.nodes );
+         }
+
+         void finish( const char * at )
+         {
+            assert( m_open.empty() );
+            m_nodes.push_back( make< void >( open{ 0, 0, 0 }, std::size_t( at - m_base ) ) );
+         }
+
+      private:
+         struct open
+         {
+            std::size_t begin;
+            std::size_t pending;
+            std::size_t nodes;
+         };
+
+         template< typename Rule >
+         node make( const open & o, const std::size_t end )
+         {
+            const auto first = m_nodes.size();
+            const auto count = m_pending.size() - o.pending;
+            m_nodes.insert( m_nodes.end(), m_pending.begin() + o.pending, m_pending.end() );
+            m_pending.resize( o.pending );
+            return node{ & typeid( Rule ), o.begin, end, first, count };
+         }
+
+         const char * m_base = nullptr;
+         std::vector< node > m_nodes;
+         std::vector< node > m_pending;
+         std::vector< open > m_open;
+      };
+
+      // Selector< Rule >::value determines whether a node is created for Rule.
+
+      template< typename Rule >
+      struct store_all : std::true_type {};
+
+      // The nodes built within a look-ahead are always dropped, and no node
+      // is created for the look-ahead itself.
+
+      template< typename Rule > struct is_lookahead : std::false_type {};
+      template< typename ... Rules > struct is_lookahead< at< Rules ... > > : std::true_type {};
+      template< typename ... Rules > struct is_lookahead< not_at< Rules ... > > : std::true_type {};
+
+      template< template< typename ... > class Selector, template< typename ... > class Base >
+      struct builder
+      {
+         template< typename Rule, bool = Selector< Rule >::value && ! is_lookahead< Rule >::value >
+         struct control_impl
+               : Base< Rule >
+         {
+            template< typename Input, typename ... States >
+            static void start( const Input & in, tree & t, States && ... st )
+            {
+               Base< Rule >::start( in, t, st ... );
+               t.start( in.begin() );
+            }
+
+            template< typename Input, typename ... States >
+            static void success( const Input & in, tree & t, States && ... st )
+            {
+               if ( is_lookahead< Rule >::value ) {
+                  t.failure();
+               }
+               else {
+                  t.keep();
+               }
+               Base< Rule >::success( in, t, st ... );
+            }
+
+            template< typename Input, typename ... States >
+            static void failure( const Input & in, tree & t, States && ... st )
+            {
+               t.failure();
+               Base< Rule >::failure( in, t, st ... );
+            }
+         };
+
+         template< typename Rule >
+         struct control_impl< Rule, true >
+               : Base< Rule >
+         {
+            template< typename Input, typename ... States >
+            static void start( const Input & in, tree & t, States && ... st )
+            {
+               Base< Rule >::start( in, t, st ... );
+               t.start( in.begin() );
+            }
+
+            template< typename Input, typename ... States >
+            static void success( const Input & in, tree & t, States && ... st )
+            {
+               t.template success< Rule >( in.begin() );
+               Base< Rule >::success( in, t, st ... );
+            }
+
+            template< typename Input, typename ... States >
+            static void failure( const Input & in, tree & t, States && ... st )
+            {
+               t.failure();
+               Base< Rule >::failure( in, t, st ... );
+            }
+         };
+
+         // Restores the tree when an exception aborts Rule, e.g. one that is
+         // then caught by a try_catch<> in the grammar.
+
+         template< typename Rule >
+         struct control
+               : control_impl< Rule >
+         {
+            template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+            static bool match( Input & in, tree & t, States && ... st )
+            {
+               const auto m = t.sizes();
+               try {
+                  return Base< Rule >::template match< A, Action, Control >( in, t, st ... );
+               }
+               catch ( ... ) {
+                  t.restore( m );
+                  throw;
+               }
+            }
+         };
+      };
+
+      // The tree is passed to the control (and action) class as first state.
+      // Only inputs where all data stays in memory for the whole parsing run
+      // are supported, i.e. not incremental inputs that discard() data.
+
+      template< typename Rule, template< typename ... > class Selector = store_all, template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename Input, typename ... States >
+      bool parse_input( Input & in, tree & t, States && ... st )
+      {
+         t.reset( in.begin() );
+
+         if ( pegtl::parse_input< Rule, Action, builder< Selector, Control >::template control >( in, t, st ... ) ) {
+            t.finish( in.begin() );
+            return true;
+         }
+         return false;
+      }
+
+      template< typename Rule, template< typename ... > class Selector = store_all, template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename ... States >
+      bool parse_string( const std::string & data, const std::string & source, tree & t, States && ... st )
+      {
+         memory_input in( 1, 0, data.data(), data.data() + data.size(), source.c_str() );
+         return parse_input< Rule, Selector, Action, Control >( in, t, st ... );
+      }
+
+   } // parse_tree
+
+} // pegtl
+
+#endif
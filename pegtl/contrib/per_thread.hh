@@ -0,0 +1,95 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_PER_THREAD_HH
+#define PEGTL_CONTRIB_PER_THREAD_HH
+
+// GCC before 4.8 and the clang of Xcode before 8 do not support thread_local,
+// for these a value-initialised object per thread is created on first use
+// and deleted at thread exit by the POSIX thread-specific storage instead.
+
+#if ! defined( PEGTL_HAS_THREAD_LOCAL )
+#  if defined( __clang__ )
+#    if __has_feature( cxx_thread_local )
+#      define PEGTL_HAS_THREAD_LOCAL 1
+#    else
+#      define PEGTL_HAS_THREAD_LOCAL 0
+#    endif
+#  elif defined( __GNUC__ ) && ( ( __GNUC__ == 4 ) && ( __GNUC_MINOR__ < 8 ) )
+#    define PEGTL_HAS_THREAD_LOCAL 0
+#  else
+#    define PEGTL_HAS_THREAD_LOCAL 1
+#  endif
+#endif
+
+#if ! PEGTL_HAS_THREAD_LOCAL
+#include <pthread.h>
+#include <system_error>
+#endif
+
+namespace pegtl
+{
+   namespace internal
+   {
+#if PEGTL_HAS_THREAD_LOCAL
+
+      template< typename T >
+      T & per_thread()
+      {
+         static thread_local T t;
+         return t;
+      }
+
+#else
+
+      template< typename T >
+      class per_thread_key
+      {
+      public:
+         per_thread_key()
+         {
+            if ( const int r = ::pthread_key_create( & m_key, & destroy ) ) {
+               throw std::system_error( r, std::system_category(), "pegtl: unable to create thread-specific key" );
+            }
+         }
+
+         per_thread_key( const per_thread_key & ) = delete;
+         void operator= ( const per_thread_key & ) = delete;
+
+         T * create() const
+         {
+            T * t = new T();
+            if ( const int r = ::pthread_setspecific( m_key, t ) ) {
+               delete t;
+               throw std::system_error( r, std::system_category(), "pegtl: unable to set thread-specific value" );
+            }
+            return t;
+         }
+
+      private:
+         ::pthread_key_t m_key;
+
+         static void destroy( void * t )
+         {
+            delete static_cast< T * >( t );
+         }
+      };
+
+      template< typename T >
+      T & per_thread()
+      {
+         static __thread T * t = nullptr;
+         if ( ! t ) {
+            static const per_thread_key< T > key;
+            t = key.create();
+         }
+         return * t;
+      }
+
+#endif
+
+   } // internal
+
+} // pegtl
+
+#endif
@@ -0,0 +1,294 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_PIPELINE_HH
+#define PEGTL_CONTRIB_PIPELINE_HH
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+#include "../parse.hh"
+#include "../normal.hh"
+#include "../nothing.hh"
+#include "../buffer_input.hh"
+
+#include "../internal/cstream_reader.hh"
+
+namespace pegtl
+{
+   namespace internal
+   {
+      // Bounded queue of chunks between one producer and one consumer thread,
+      // a ring of capacity slots. The consumer returns the chunks it is done with, they are re-used by
+      // the producer to avoid allocating new memory for every chunk. Errors
+      // of the producer are passed on to the consumer, and the consumer can
+      // cancel the producer.
+
+      class chunk_queue
+      {
+      public:
+         explicit
+         chunk_queue( const std::size_t capacity )
+               : m_chunks( std::max( capacity, std::size_t( 1 ) ) )
+         { }
+
+         chunk_queue( const chunk_queue & ) = delete;
+         void operator= ( const chunk_queue & ) = delete;
+
+         // Producer side.
+
+         std::string acquire()
+         {
+            std::string nrv;
+            const std::lock_guard< std::mutex > lock( m_mutex );
+            if ( ! m_free.empty() ) {
+               nrv = std::move( m_free.back() );
+               m_free.pop_back();
+            }
+            return nrv;
+         }
+
+         // Returns false when the consumer has cancelled the queue.
+
+         bool push( std::string && chunk )
+         {
+            std::unique_lock< std::mutex > lock( m_mutex );
+            m_not_full.wait( lock, [ this ](){ return m_cancelled || ( m_size < m_chunks.size() ); } );
+            if ( m_cancelled ) {
+               return false;
+            }
+            m_chunks[ ( m_front + m_size ) % m_chunks.size() ] = std::move( chunk );
+            ++m_size;
+            m_not_empty.notify_one();
+            return true;
+         }
+
+         void finish( const std::exception_ptr & error = std::exception_ptr() )
+         {
+            const std::lock_guard< std::mutex > lock( m_mutex );
+            m_finished = true;
+            m_error = error;
+            m_not_empty.notify_one();
+         }
+
+         // Consumer side; pop() returns false after the last chunk or when the
+         // queue was cancelled, or rethrows the exception that was passed to
+         // finish() by the producer.
+
+         bool pop( std::string & chunk )
+         {
+            std::unique_lock< std::mutex > lock( m_mutex );
+            m_not_empty.wait( lock, [ this ](){ return m_finished || m_cancelled || ( m_size != 0 ); } );
+            if ( m_cancelled ) {
+               return false;
+            }
+            if ( m_size != 0 ) {
+               chunk = std::move( m_chunks[ m_front ] );
+               m_front = ( m_front + 1 ) % m_chunks.size();
+               --m_size;
+               m_not_full.notify_one();
+               return true;
+            }
+            if ( m_error ) {
+               std::rethrow_exception( m_error );
+            }
+            return false;
+         }
+
+         void recycle( std::string && chunk )
+         {
+            const std::lock_guard< std::mutex > lock( m_mutex );
+            if ( m_free.size() < m_chunks.size() ) {
+               m_free.push_back( std::move( chunk ) );
+            }
+         }
+
+         void cancel()
+         {
+            const std::lock_guard< std::mutex > lock( m_mutex );
+            m_cancelled = true;
+            m_not_full.notify_one();
+            m_not_empty.notify_one();
+         }
+
+      private:
+         std::vector< std::string > m_chunks;  // The ring, its size is the capacity.
+         std::vector< std::string > m_free;
+         std::size_t m_front = 0;
+         std::size_t m_size = 0;
+         bool m_finished = false;
+         bool m_cancelled = false;
+         std::exception_ptr m_error;
+         std::mutex m_mutex;
+         std::condition_variable m_not_full;
+         std::condition_variable m_not_empty;
+      };
+
+   } // internal
+
+   // Default for the transformation stage of the pipeline_reader, which
+   // means that the chunks are passed from the reader to the parser as-is.
+
+   struct pipeline_identity
+   {
+      void operator() ( const char * data, const std::size_t size, std::string & output )
+      {
+         output.append( data, size );
+      }
+   };
+
+   // Reader for buffer_input that decouples reading the data, and optionally
+   // transforming it, e.g. decompressing or transcoding, from parsing the data.
+   // The Reader, with the same interface as the readers for buffer_input, runs
+   // in its own thread and reads chunks of up to chunk_size bytes into a queue
+   // of at most queue_size chunks. Unless the Transform is pipeline_identity,
+   // it also runs in its own thread, and is called as transform( data, size,
+   // output ) for every chunk, where it appends the transformed data to the
+   // initially empty output; it is called with size 0 after the last chunk.
+   // Exceptions thrown by the reader or transformation are rethrown in the
+   // parsing thread. The destructor waits for the reader to return from its
+   // current call.
+
+   template< typename Reader, typename Transform = pipeline_identity >
+   class pipeline_reader
+   {
+   public:
+      explicit
+      pipeline_reader( Reader reader, Transform transform = Transform(), const std::size_t chunk_size = 1 << 16, const std::size_t queue_size = 16 )
+            : m_reader( std::move( reader ) ),
+              m_transform( std::move( transform ) ),
+              m_read( queue_size ),
+              m_transformed( queue_size ),
+              m_queue( transforming ? m_transformed : m_read )
+      {
+         m_reader_thread = std::thread( [ this, chunk_size ](){ run_reader( chunk_size ); } );
+         if ( transforming ) {
+            try {
+               m_transform_thread = std::thread( [ this ](){ run_transform(); } );
+            }
+            catch ( ... ) {
+               m_read.cancel();
+               m_reader_thread.join();
+               throw;
+            }
+         }
+      }
+
+      pipeline_reader( const pipeline_reader & ) = delete;
+      void operator= ( const pipeline_reader & ) = delete;
+
+      ~pipeline_reader()
+      {
+         m_read.cancel();
+         m_transformed.cancel();
+         if ( m_transform_thread.joinable() ) {
+            m_transform_thread.join();
+         }
+         m_reader_thread.join();
+      }
+
+      std::size_t operator() ( char * buffer, const std::size_t length )
+      {
+         while ( m_offset == m_chunk.size() ) {
+            m_queue.recycle( std::move( m_chunk ) );
+            m_chunk.clear();
+            m_offset = 0;
+            if ( ! m_queue.pop( m_chunk ) ) {
+               return 0;
+            }
+         }
+         const std::size_t r = std::min( length, m_chunk.size() - m_offset );
+         std::memcpy( buffer, m_chunk.data() + m_offset, r );
+         m_offset += r;
+         return r;
+      }
+
+   private:
+      static constexpr bool transforming = ! std::is_same< Transform, pipeline_identity >::value;
+
+      Reader m_reader;
+      Transform m_transform;
+      internal::chunk_queue m_read;
+      internal::chunk_queue m_transformed;
+      internal::chunk_queue & m_queue;
+      std::thread m_reader_thread;
+      std::thread m_transform_thread;
+      std::string m_chunk;
+      std::size_t m_offset = 0;
+
+      void run_reader( const std::size_t chunk_size )
+      {
+         try {
+            for ( ;; ) {
+               std::string c = m_read.acquire();
+               c.resize( chunk_size );
+               const std::size_t r = m_reader( & c[ 0 ], chunk_size );
+               if ( ! r ) {
+                  break;
+               }
+               c.resize( r );
+               if ( ! m_read.push( std::move( c ) ) ) {
+                  return;
+               }
+            }
+            m_read.finish();
+         }
+         catch ( ... ) {
+            m_read.finish( std::current_exception() );
+         }
+      }
+
+      void run_transform()
+      {
+         try {
+            std::string c;
+            while ( m_read.pop( c ) ) {
+               std::string t = m_transformed.acquire();
+               t.clear();
+               m_transform( c.data(), c.size(), t );
+               m_read.recycle( std::move( c ) );
+               if ( ( ! t.empty() ) && ( ! m_transformed.push( std::move( t ) ) ) ) {
+                  m_read.cancel();
+                  return;
+               }
+            }
+            std::string t;
+            m_transform( nullptr, 0, t );
+            if ( ( ! t.empty() ) && ( ! m_transformed.push( std::move( t ) ) ) ) {
+               return;
+            }
+            m_transformed.finish();
+         }
+         catch ( ... ) {
+            m_read.cancel();
+            m_transformed.finish( std::current_exception() );
+         }
+      }
+   };
+
+   template< typename Rule, template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename Transform = pipeline_identity, typename ... States >
+   bool parse_cstream_pipelined( std::FILE * stream, const char * source, const std::size_t maximum, States && ... st )
+   {
+      buffer_input< pipeline_reader< internal::cstream_reader, Transform > > in( source, maximum, internal::cstream_reader( stream ) );
+      return parse_input< Rule, Action, Control >( in, st ... );
+   }
+
+   template< typename Rule, template< typename ... > class Action = nothing, template< typename ... > class Control = normal, typename Transform = pipeline_identity, typename ... States >
+   bool parse_stdin_pipelined( const std::size_t maximum, States && ... st )
+   {
+      return parse_cstream_pipelined< Rule, Action, Control, Transform >( stdin, "stdin", maximum, st ... );
+   }
+
+} // pegtl
+
+#endif
@@ -0,0 +1,268 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_POOLED_STATE_HH
+#define PEGTL_CONTRIB_POOLED_STATE_HH
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+#include "../normal.hh"
+#include "../apply_mode.hh"
+
+#include "../internal/seq.hh"
+#include "../internal/state.hh"
+#include "../internal/skip_control.hh"
+#include "../internal/rule_match_three.hh"
+
+#include "../analysis/generic.hh"
+
+#include "changes.hh"
+
+namespace pegtl
+{
+   class state_pool;
+
+   namespace internal
+   {
+      // The objects handed out by a state_pool<> know their pool, which is
+      // how pooled states nested inside of other pooled states find it.
+
+      struct pool_link
+      {
+         explicit pool_link( state_pool & p )
+               : pool( p )
+         { }
+
+         state_pool & pool;
+      };
+
+      template< typename State >
+      struct pooled
+            : State,
+              pool_link
+      {
+         explicit pooled( state_pool & p )
+               : pool_link( p )
+         { }
+      };
+
+      template< typename T, typename D = typename std::decay< T >::type >
+      struct is_pool_state
+            : std::integral_constant< bool, std::is_same< D, state_pool >::value || std::is_base_of< pool_link, D >::value > {};
+
+      template< typename ... States > struct has_pool_state : std::false_type {};
+      template< typename S, typename ... States > struct has_pool_state< S, States ... > : std::integral_constant< bool, is_pool_state< S >::value || has_pool_state< States ... >::value > {};
+
+      inline state_pool * get_pool( state_pool & p )
+      {
+         return & p;
+      }
+
+      inline state_pool * get_pool( pool_link & l )
+      {
+         return & l.pool;
+      }
+
+      template< typename S >
+      state_pool * get_pool( S &, typename std::enable_if< ! is_pool_state< S >::value >::type * = nullptr )
+      {
+         return nullptr;
+      }
+
+      inline state_pool * find_pool()
+      {
+         return nullptr;
+      }
+
+      template< typename S, typename ... States >
+      state_pool * find_pool( S & s, States & ... st )
+      {
+         if ( state_pool * p = get_pool( s ) ) {
+            return p;
+         }
+         return find_pool( st ... );
+      }
+
+      template< typename State, typename ... States >
+      state_pool & pool_for( States & ... st )
+      {
+         static_assert( has_pool_state< States ... >::value, "pooled states require a pegtl::state_pool among the states passed to the parsing function" );
+         return * find_pool( st ... );
+      }
+
+   } // internal
+
+   // Free lists of default-constructed state objects, one per State type.
+   // An instance is passed as additional state to the parsing function, or
+   // to any other function that owns the parsing run, and the pooled states
+   // then take their objects from it; the pool, and all objects, are
+   // destroyed with the instance. An object is reset() when returned to
+   // the pool, which usually clears it while retaining the capacity of its
+   // buffers; the reset() function MUST NOT throw.
+
+   class state_pool
+   {
+   public:
+      state_pool() = default;
+
+      state_pool( const state_pool & ) = delete;
+      void operator= ( const state_pool & ) = delete;
+
+      template< typename State >
+      class handle
+      {
+      public:
+         explicit handle( state_pool & p )
+               : m_pool( p ),
+                 m_state( p.acquire< State >() )
+         { }
+
+         ~handle()
+         {
+            m_pool.release( m_state );
+         }
+
+         handle( const handle & ) = delete;
+         void operator= ( const handle & ) = delete;
+
+         internal::pooled< State > & operator* () const
+         {
+            return * m_state;
+         }
+
+      private:
+         state_pool & m_pool;
+         internal::pooled< State > * m_state;
+      };
+
+      template< typename State >
+      std::size_t size() const
+      {
+         for ( const auto & l : m_lists ) {
+            if ( l.first == key< State >() ) {
+               return static_cast< const list< State > & >( * l.second ).objects.size();
+            }
+         }
+         return 0;
+      }
+
+   private:
+      struct list_base
+      {
+         virtual ~list_base() = default;
+      };
+
+      template< typename State >
+      struct list
+            : list_base
+      {
+         std::vector< std::unique_ptr< internal::pooled< State > > > objects;
+      };
+
+      std::vector< std::pair< const void *, std::unique_ptr< list_base > > > m_lists;
+
+      template< typename State >
+      static const void * key()
+      {
+         static const char k = 0;
+         return & k;
+      }
+
+      template< typename State >
+      list< State > & get()
+      {
+         for ( const auto & l : m_lists ) {
+            if ( l.first == key< State >() ) {
+               return static_cast< list< State > & >( * l.second );
+            }
+         }
+         m_lists.emplace_back( key< State >(), std::unique_ptr< list_base >( new list< State >() ) );
+         return static_cast< list< State > & >( * m_lists.back().second );
+      }
+
+      template< typename State >
+      internal::pooled< State > * acquire()
+      {
+         auto & f = get< State >().objects;
+         if ( f.empty() ) {
+            return new internal::pooled< State >( * this );
+         }
+         internal::pooled< State > * s = f.back().release();
+         f.pop_back();
+         return s;
+      }
+
+      template< typename State >
+      void release( internal::pooled< State > * s )
+      {
+         std::unique_ptr< internal::pooled< State > > p( s );
+         p->reset();
+         get< State >().objects.push_back( std::move( p ) );
+      }
+   };
+
+   namespace internal
+   {
+      template< typename State, typename ... Rules >
+      struct pooled_state
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::SEQ, Rules ... >;
+
+         template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+         static bool match( Input & in, States && ... st )
+         {
+            const state_pool::handle< State > h( pool_for< State >( st ... ) );
+            if ( rule_match_three< seq< Rules ... >, A, Action, Control >::match( in, * h ) ) {
+               state< State, Rules ... >::template success< A, Action, Control >( * h, in, st ... );
+               return true;
+            }
+            return false;
+         }
+      };
+
+      template< typename State, typename ... Rules >
+      struct skip_control< pooled_state< State, Rules ... > > : std::true_type {};
+
+   } // internal
+
+   // Like state< State, Rules ... > except that the State is taken from and
+   // returned to the state_pool that must be one of the states (or, within
+   // another pooled state, known to the pooled state object) for every match
+   // attempt; it is reset() when returned, instead of being destroyed. The
+   // Rules see an object of a class derived from State.
+
+   template< typename State, typename ... Rules > struct pooled_state : internal::pooled_state< State, Rules ... > {};
+
+   // Like change_state< Rule, State, Base > except that the State is taken
+   // from a state_pool in the same way as for pooled_state<>.
+
+   template< typename Rule, typename State, template< typename ... > class Base = pegtl::normal >
+   struct change_pooled_state
+         : public Base< Rule >
+   {
+      template< pegtl::apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static typename std::enable_if< A == pegtl::apply_mode::ACTION, bool >::type match( Input & in, States && ... st )
+      {
+         const state_pool::handle< State > h( internal::pool_for< State >( st ... ) );
+
+         if ( Base< Rule >::template match< A, Action, Control >( in, * h ) ) {
+            ( * h ).success( st ... );
+            return true;
+         }
+         return false;
+      }
+
+      template< pegtl::apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static typename std::enable_if< A != pegtl::apply_mode::ACTION, bool >::type match( Input & in, States && ... )
+      {
+         internal::dummy_disabled_state s;
+         return Base< Rule >::template match< A, Action, Control >( in, s );
+      }
+   };
+
+} // pegtl
+
+#endif
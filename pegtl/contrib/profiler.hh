@@ -0,0 +1,195 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_PROFILER_HH
+#define PEGTL_CONTRIB_PROFILER_HH
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <algorithm>
+
+#include "../parse.hh"
+#include "../normal.hh"
+#include "../nothing.hh"
+#include "../apply_mode.hh"
+#include "../buffer_input.hh"
+
+#include "rule_id.hh"
+#include "per_thread.hh"
+
+namespace pegtl
+{
+   struct profile_entry
+   {
+      std::size_t start = 0;
+      std::size_t success = 0;
+      std::size_t failure = 0;
+      std::uint64_t bytes = 0;  // Consumed by successful matches.
+      std::uint64_t nanoseconds = 0;  // Inclusive, only for the timed_profiler.
+   };
+
+   // The per-rule data collected by the profiler and timed_profiler control
+   // classes for the current thread, indexed by internal::rule_id< Rule >.
+   // Matches that were aborted by an exception are neither counted as success
+   // nor as failure.
+
+   class profile
+   {
+   public:
+      static std::vector< profile_entry > & entries()
+      {
+         return data().entries;
+      }
+
+      static profile_entry & entry( const std::size_t id )
+      {
+         auto & e = entries();
+         if ( id >= e.size() ) {
+            e.resize( internal::rule_registry::size() );
+         }
+         return e[ id ];
+      }
+
+      // The statistics of the buffer_input that was last recorded, if any.
+
+      static buffer_stats & buffer()
+      {
+         return data().buffer;
+      }
+
+      static void reset()
+      {
+         auto & e = entries();
+         e.assign( e.size(), profile_entry() );
+         buffer() = buffer_stats();
+      }
+
+      // Copies the statistics of a buffer_input to buffer(), does nothing
+      // for other inputs.
+
+      template< typename Input >
+      static void record( const Input & in )
+      {
+         record( in, 0 );
+      }
+
+      // Prints one line for every rule that was attempted, sorted by time
+      // and then by number of match attempts.
+
+      static void report( std::ostream & o )
+      {
+         report( o, entries(), buffer() );
+      }
+
+      // Prints a table with the same layout as report() for other per-rule
+      // data, e.g. that of an instrument::profile_sink.
+
+      static void report( std::ostream & o, const std::vector< profile_entry > & e, const buffer_stats & b )
+      {
+         std::vector< std::size_t > ids;
+         for ( std::size_t i = 0; i < e.size(); ++i ) {
+            if ( e[ i ].start ) {
+               ids.push_back( i );
+            }
+         }
+         std::sort( ids.begin(), ids.end(), [ & ]( const std::size_t l, const std::size_t r ){ return ( e[ l ].nanoseconds != e[ r ].nanoseconds ) ? ( e[ l ].nanoseconds > e[ r ].nanoseconds ) : ( e[ l ].start > e[ r ].start ); } );
+
+         o << std::setw( 12 ) << "start" << std::setw( 12 ) << "success" << std::setw( 12 ) << "failure" << std::setw( 12 ) << "raised" << std::setw( 14 ) << "bytes" << std::setw( 12 ) << "time[ms]" << "  rule\n";
+         for ( const auto i : ids ) {
+            const auto & p = e[ i ];
+            o << std::setw( 12 ) << p.start << std::setw( 12 ) << p.success << std::setw( 12 ) << p.failure << std::setw( 12 ) << ( p.start - p.success - p.failure ) << std::setw( 14 ) << p.bytes << std::setw( 12 ) << std::fixed << std::setprecision( 3 ) << ( p.nanoseconds / 1e6 ) << "  " << internal::rule_registry::name( i ) << '\n';
+         }
+         if ( b.reader_calls ) {
+            o << "buffer: maximum " << b.maximum_buffered << " bytes" << ( b.maximum_reached ? " (full)" : "" ) << ", " << b.reader_calls << " reads of " << b.read_bytes << " of " << b.requested_bytes << " bytes, " << b.discards << " discards moved " << b.moved_bytes << " bytes\n";
+         }
+      }
+
+   private:
+      struct state
+      {
+         std::vector< profile_entry > entries = std::vector< profile_entry >( internal::rule_registry::size() );
+         buffer_stats buffer;
+      };
+
+      static state & data()
+      {
+         return internal::per_thread< state >();
+      }
+
+      template< typename Input >
+      static auto record( const Input & in, int ) -> decltype( in.stats(), void() )
+      {
+         buffer() = in.stats();
+      }
+
+      template< typename Input >
+      static void record( const Input &, long )
+      { }
+   };
+
+   // Control class that counts match attempts, successes and failures, and
+   // the bytes consumed, for every rule in a table instead of printing
+   // anything like the tracer. The timed_profiler additionally measures
+   // the (inclusive) time spent in every rule with a steady clock.
+
+   template< typename Rule >
+   struct profiler
+         : normal< Rule >
+   {
+      template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static bool match( Input & in, States && ... st )
+      {
+         // No reference to the entry is kept while matching since the table can grow.
+         const std::size_t id = internal::rule_id< Rule >::value;
+         ++profile::entry( id ).start;
+         const char * begin = in.begin();
+         if ( normal< Rule >::template match< A, Action, Control >( in, st ... ) ) {
+            auto & p = profile::entry( id );
+            ++p.success;
+            p.bytes += in.begin() - begin;
+            return true;
+         }
+         ++profile::entry( id ).failure;
+         return false;
+      }
+   };
+
+   template< typename Rule >
+   struct timed_profiler
+         : normal< Rule >
+   {
+      template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+      static bool match( Input & in, States && ... st )
+      {
+         const auto t = std::chrono::steady_clock::now();
+         const bool result = profiler< Rule >::template match< A, Action, Control >( in, st ... );
+         profile::entry( internal::rule_id< Rule >::value ).nanoseconds += std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - t ).count();
+         return result;
+      }
+   };
+
+   // Like parse_input() with the profiler as default control class, and
+   // with a final profile::record( in ), also when an exception is thrown,
+   // so that the buffer statistics are included in the report.
+
+   template< typename Rule, template< typename ... > class Action = nothing, template< typename ... > class Control = profiler, typename Input, typename ... States >
+   bool profile_input( Input & in, States && ... st )
+   {
+      try {
+         const bool result = parse_input< Rule, Action, Control >( in, st ... );
+         profile::record( in );
+         return result;
+      }
+      catch ( ... ) {
+         profile::record( in );
+         throw;
+      }
+   }
+
+} // pegtl
+
+#endif
@@ -0,0 +1,65 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_RULE_ID_HH
+#define PEGTL_CONTRIB_RULE_ID_HH
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "../internal/demangle.hh"
+
+namespace pegtl
+{
+   namespace internal
+   {
+      // Registry of all rules for which a rule_id was instantiated; the
+      // demangled names are only generated on demand.
+
+      class rule_registry
+      {
+      public:
+         static std::size_t add( std::string ( * name )() )
+         {
+            auto & n = names();
+            n.push_back( name );
+            return n.size() - 1;
+         }
+
+         static std::size_t size()
+         {
+            return names().size();
+         }
+
+         static std::string name( const std::size_t id )
+         {
+            return names()[ id ]();
+         }
+
+      private:
+         static std::vector< std::string ( * )() > & names()
+         {
+            static std::vector< std::string ( * )() > n;
+            return n;
+         }
+      };
+
+      // Dense numbering of rules for instrumentation that keeps per-rule data
+      // in tables. The ids are assigned during static initialisation, which
+      // makes reading the id a simple load in the instrumented code.
+
+      template< typename Rule >
+      struct rule_id
+      {
+         static const std::size_t value;
+      };
+
+      template< typename Rule >
+      const std::size_t rule_id< Rule >::value = rule_registry::add( & demangle< Rule > );
+
+   } // internal
+
+} // pegtl
+
+#endif
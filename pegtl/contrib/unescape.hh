@@ -6,10 +6,15 @@
 
 #include <string>
 #include <cassert>
+#include <cstring>
 
 #include <pegtl/ascii.hh>
+#include <pegtl/apply_mode.hh>
 #include <pegtl/parse_error.hh>
 
+#include <pegtl/internal/swar.hh>
+#include <pegtl/analysis/generic.hh>
+
 namespace pegtl
 {
    namespace unescape
@@ -172,6 +177,252 @@ namespace pegtl
          }
       };
 
+      // Bulk unescaping of the content of a JSON string that was already
+      // matched by json_content below (or json::string::content). The
+      // result is reserved once since unescaping never makes the data
+      // longer, the spans between escape sequences are found with memchr()
+      // and appended in one go, and UTF-16 surrogate pairs are translated
+      // into a single UTF-8 sequence, as required for JSON by RFC 7159.
+
+      inline void unescape_json_content( const char * begin, const char * const end, std::string & result )
+      {
+         result.reserve( result.size() + ( end - begin ) );
+
+         while ( const char * b = static_cast< const char * >( std::memchr( begin, '\\', end - begin ) ) ) {
+            result.append( begin, b );
+            switch ( const char c = b[ 1 ] ) {
+               case 'u': {
+                  const auto u = unhex_string< unsigned >( b + 2, b + 6 );
+                  begin = b + 6;
+                  if ( ( 0xd800 <= u ) && ( u <= 0xdbff ) && ( end - begin >= 6 ) && ( begin[ 0 ] == '\\' ) && ( begin[ 1 ] == 'u' ) ) {
+                     const auto v = unhex_string< unsigned >( begin + 2, begin + 6 );
+                     if ( ( 0xdc00 <= v ) && ( v <= 0xdfff ) ) {
+                        begin += 6;
+                        utf8_append_utf32( result, ( ( ( u & 0x03ff ) << 10 ) | ( v & 0x03ff ) ) + 0x10000 );
+                        continue;
+                     }
+                  }
+                  utf8_append_utf32( result, u );
+               }  continue;
+               case 'b':
+                  result += '\b';
+                  break;
+               case 'f':
+                  result += '\f';
+                  break;
+               case 'n':
+                  result += '\n';
+                  break;
+               case 'r':
+                  result += '\r';
+                  break;
+               case 't':
+                  result += '\t';
+                  break;
+               default:
+                  result += c;  // One of '"', '\\' and '/'.
+                  break;
+            }
+            begin = b + 2;
+         }
+         result.append( begin, end );
+      }
+
+      // This action MUST only be called for input matching json_content
+      // or json::string::content (or json::key::content).
+
+      struct unescape_json
+      {
+         template< typename Input, typename State >
+         static void apply( const Input & in, State & st )
+         {
+            unescape_json_content( in.begin(), in.end(), st.unescaped );
+         }
+      };
+
+      // Rule that matches the content of a JSON string, i.e. everything
+      // up to but excluding the closing quote, and validates the escape
+      // sequences and UTF-8 encoding like json::string::content. Runs of
+      // printable ASCII characters are skipped eight bytes at a time; the
+      // unescape_json action can be attached to this rule.
+
+      struct json_content
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::OPT >;
+
+         static bool plain( const std::uint64_t v )
+         {
+            return ! ( internal::swar_has_high_bit( v ) || internal::swar_has_less< 0x20 >( v ) || internal::swar_has_byte< '"' >( v ) || internal::swar_has_byte< '\\' >( v ) );
+         }
+
+         static bool is_xdigit( const char c )
+         {
+            return ( ( '0' <= c ) && ( c <= '9' ) ) || ( ( 'a' <= c ) && ( c <= 'f' ) ) || ( ( 'A' <= c ) && ( c <= 'F' ) );
+         }
+
+         // Returns the length of the valid UTF-8 sequence at p, or 0; accepts
+         // the same sequences as utf8::range< 0x80, 0x10FFFF >.
+
+         static std::size_t utf8_length( const char * p, const std::size_t size )
+         {
+            const unsigned char c0 = p[ 0 ];
+            const std::size_t n = ( ( c0 & 0xe0 ) == 0xc0 ) ? 2 : ( ( c0 & 0xf0 ) == 0xe0 ) ? 3 : ( ( c0 & 0xf8 ) == 0xf0 ) ? 4 : 0;
+            if ( ( n == 0 ) || ( size < n ) ) {
+               return 0;
+            }
+            char32_t c = c0 & ( 0x7f >> n );
+            for ( std::size_t i = 1; i < n; ++i ) {
+               const unsigned char ci = p[ i ];
+               if ( ( ci & 0xc0 ) != 0x80 ) {
+                  return 0;
+               }
+               c = ( c << 6 ) | ( ci & 0x3f );
+            }
+            static const char32_t minimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+            return ( ( c >= minimum[ n ] ) && ( c <= 0x10ffff ) ) ? n : 0;
+         }
+
+         // Appends the escape sequence at p, which was already validated, to
+         // the result, and returns its length; like unescape_json_content()
+         // a surrogate pair of two escape sequences is translated into one
+         // UTF-8 sequence when the second one is complete and valid.
+
+         static std::size_t append_escape( const char * p, const std::size_t size, std::string & result )
+         {
+            switch ( const char c = p[ 1 ] ) {
+               case 'u': {
+                  const auto u = unhex_string< unsigned >( p + 2, p + 6 );
+                  if ( ( 0xd800 <= u ) && ( u <= 0xdbff ) && ( size >= 12 ) && ( p[ 6 ] == '\\' ) && ( p[ 7 ] == 'u' ) && is_xdigit( p[ 8 ] ) && is_xdigit( p[ 9 ] ) && is_xdigit( p[ 10 ] ) && is_xdigit( p[ 11 ] ) ) {
+                     const auto v = unhex_string< unsigned >( p + 8, p + 12 );
+                     if ( ( 0xdc00 <= v ) && ( v <= 0xdfff ) ) {
+                        utf8_append_utf32( result, ( ( ( u & 0x03ff ) << 10 ) | ( v & 0x03ff ) ) + 0x10000 );
+                        return 12;
+                     }
+                  }
+                  utf8_append_utf32( result, u );
+               }  return 6;
+               case 'b':
+                  result += '\b';
+                  return 2;
+               case 'f':
+                  result += '\f';
+                  return 2;
+               case 'n':
+                  result += '\n';
+                  return 2;
+               case 'r':
+                  result += '\r';
+                  return 2;
+               case 't':
+                  result += '\t';
+                  return 2;
+               default:
+                  result += c;  // One of '"', '\\' and '/'.
+                  return 2;
+            }
+         }
+
+         // Validates, and with Unescape appends the unescaped content to
+         // the result while scanning, i.e. the spans without escapes are
+         // appended in one go when the next escape sequence or the end of
+         // the content is found.
+
+         template< bool Unescape, typename Input >
+         static bool scan( Input & in, std::string & result )
+         {
+            std::size_t i = 0;
+            std::size_t span = 0;
+
+            for ( ;; ) {
+               std::size_t s = in.size( i + 8 );
+               const char * p = in.begin();
+
+               while ( ( i + 8 <= s ) && plain( internal::swar_load( p + i ) ) ) {
+                  i += 8;
+               }
+               if ( i >= s ) {
+                  return false;
+               }
+               const unsigned char c = p[ i ];
+
+               if ( c == '"' ) {
+                  if ( Unescape ) {
+                     result.append( p + span, p + i );
+                  }
+                  in.bump_in_this_line( i );  // The content can not contain a line feed.
+                  return true;
+               }
+               else if ( c == '\\' ) {
+                  s = in.size( i + 12 );
+                  if ( s < i + 2 ) {
+                     return false;
+                  }
+                  switch ( p[ i + 1 ] ) {
+                     case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                        break;
+                     case 'u':
+                        if ( ( s < i + 6 ) || ! ( is_xdigit( p[ i + 2 ] ) && is_xdigit( p[ i + 3 ] ) && is_xdigit( p[ i + 4 ] ) && is_xdigit( p[ i + 5 ] ) ) ) {
+                           return false;
+                        }
+                        break;
+                     default:
+                        return false;
+                  }
+                  if ( Unescape ) {
+                     result.append( p + span, p + i );
+                     i += append_escape( p + i, s - i, result );
+                     span = i;
+                  }
+                  else {
+                     i += ( p[ i + 1 ] == 'u' ) ? 6 : 2;
+                  }
+               }
+               else if ( c < 0x20 ) {
+                  return false;
+               }
+               else if ( c < 0x80 ) {
+                  ++i;
+               }
+               else if ( const auto n = utf8_length( p + i, in.size( i + 4 ) - i ) ) {
+                  i += n;
+               }
+               else {
+                  return false;
+               }
+            }
+         }
+
+         template< typename Input >
+         static bool match( Input & in )
+         {
+            std::string unused;
+            return scan< false >( in, unused );
+         }
+      };
+
+      // Rule that matches and validates like json_content, and that appends
+      // the unescaped content to the member unescaped of the first state,
+      // e.g. an unescape::state, in the same pass. Nothing is appended when
+      // actions are disabled, and nothing remains appended when it fails.
+
+      struct json_unescaped
+            : json_content
+      {
+         template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename State, typename ... States >
+         static bool match( Input & in, State & st, States && ... )
+         {
+            if ( A != apply_mode::ACTION ) {
+               return json_content::match( in );
+            }
+            const auto size = st.unescaped.size();
+            if ( scan< true >( in, st.unescaped ) ) {
+               return true;
+            }
+            st.unescaped.resize( size );
+            return false;
+         }
+      };
+
    } // unescape
 
 } // pegtl
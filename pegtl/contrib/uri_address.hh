@@ -0,0 +1,256 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_URI_ADDRESS_HH
+#define PEGTL_CONTRIB_URI_ADDRESS_HH
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+#include "../apply_mode.hh"
+#include "../nothing.hh"
+
+#include "../internal/swar.hh"
+
+#include "../analysis/generic.hh"
+
+namespace pegtl
+{
+   namespace uri
+   {
+      using ipv4_bytes = std::array< unsigned char, 4 >;
+      using ipv6_bytes = std::array< unsigned char, 16 >;
+
+   } // uri
+
+   namespace internal
+   {
+      // The decoders always load eight bytes at a time, near the end of the
+      // input they work on a copy that is padded with zeros. They return the
+      // length of the address, or 0 when there is none.
+
+      // Like uri::dec_octet, i.e. three digits are accepted when followed
+      // by another digit, one or two digits are not.
+
+      inline std::size_t ipv4_octet( const char * p, unsigned char & o )
+      {
+         const std::uint64_t v = swar_load( p );
+         const unsigned n = swar_count_leading( swar_in_range< '0', '9' >( v ) );
+         const std::uint64_t d = v - swar_broadcast( '0' );  // Correct for the leading digits.
+         const unsigned d0 = unsigned( d & 0xff );
+         if ( n == 0 ) {
+            return 0;
+         }
+         if ( ( n == 1 ) || ( d0 == 0 ) ) {
+            o = ( unsigned char )( d0 );
+            return 1;
+         }
+         const unsigned d1 = unsigned( ( d >> 8 ) & 0xff );
+         if ( n == 2 ) {
+            o = ( unsigned char )( d0 * 10 + d1 );
+            return 2;
+         }
+         const unsigned x = d0 * 100 + d1 * 10 + unsigned( ( d >> 16 ) & 0xff );
+         if ( x > 255 ) {
+            return 0;
+         }
+         o = ( unsigned char )( x );
+         return 3;
+      }
+
+      inline std::size_t ipv4_decode( const char * p, unsigned char * out )
+      {
+         std::size_t i = 0;
+         for ( unsigned k = 0; k < 4; ++k ) {
+            if ( k ) {
+               if ( p[ i ] != '.' ) {
+                  return 0;
+               }
+               ++i;
+            }
+            const std::size_t n = ipv4_octet( p + i, out[ k ] );
+            if ( ! n ) {
+               return 0;
+            }
+            i += n;
+         }
+         return i;
+      }
+
+      // Converts the first n <= 4 bytes of v, which have to be hex digits.
+
+      inline unsigned ipv6_h16( const std::uint64_t v, const unsigned n )
+      {
+         const std::uint64_t nibbles = ( v & swar_broadcast( 0x0f ) ) + ( ( v >> 6 ) & swar_broadcast( 0x01 ) ) * 9;
+         const std::uint64_t x = ( nibbles << ( 8 * ( 4 - n ) ) ) & 0xffffffff;
+         const std::uint64_t y = ( ( x << 4 ) | ( x >> 8 ) ) & 0x00ff00ff;
+         return unsigned( ( ( y & 0xff ) << 8 ) | ( y >> 16 ) );
+      }
+
+      // Decodes the groups from left to right, remembering where the "::"
+      // was, instead of trying the alternatives of uri::IPv6address.
+
+      inline std::size_t ipv6_decode( const char * p, unsigned char * out )
+      {
+         unsigned g[ 8 ];
+         unsigned n = 0;
+         unsigned gap = 8;  // The number of groups before the "::", 8 for none.
+         bool required = true;
+         std::size_t i = 0;
+
+         if ( p[ 0 ] == ':' ) {
+            if ( p[ 1 ] != ':' ) {
+               return 0;
+            }
+            gap = 0;
+            required = false;
+            i = 2;
+         }
+         for ( ;; ) {
+            const std::uint64_t v = swar_load( p + i );
+            const unsigned h = swar_count_leading( swar_hex_digits( v ) );
+            if ( h == 0 ) {
+               if ( required ) {
+                  return 0;
+               }
+               break;
+            }
+            if ( p[ i + h ] == '.' ) {
+               unsigned char b[ 4 ];
+               const std::size_t m = ipv4_decode( p + i, b );
+               if ( ( ! m ) || ( n > ( ( gap == 8 ) ? 6 : 5 ) ) ) {
+                  return 0;
+               }
+               g[ n++ ] = ( unsigned( b[ 0 ] ) << 8 ) | b[ 1 ];
+               g[ n++ ] = ( unsigned( b[ 2 ] ) << 8 ) | b[ 3 ];
+               i += m;
+               break;
+            }
+            if ( h > 4 ) {
+               return 0;
+            }
+            g[ n++ ] = ipv6_h16( v, h );
+            i += h;
+            if ( ( n == ( ( gap == 8 ) ? 8 : 7 ) ) || ( p[ i ] != ':' ) ) {
+               break;
+            }
+            if ( p[ i + 1 ] == ':' ) {
+               if ( gap != 8 ) {
+                  break;
+               }
+               gap = n;
+               required = false;
+               i += 2;
+               if ( n == 7 ) {
+                  break;
+               }
+            }
+            else {
+               required = true;
+               i += 1;
+            }
+         }
+         if ( ( gap == 8 ) && ( n != 8 ) ) {
+            return 0;
+         }
+         const unsigned zeros = 8 - n;
+         for ( unsigned k = 0; k < 8; ++k ) {
+            const unsigned x = ( k < gap ) ? g[ k ] : ( k < gap + zeros ) ? 0 : g[ k - zeros ];
+            out[ 2 * k ] = ( unsigned char )( x >> 8 );
+            out[ 2 * k + 1 ] = ( unsigned char )( x );
+         }
+         return i;
+      }
+
+      // The number of bytes that the decoders can look at: ipv4_decode()
+      // loads the last octet at offset 12 at most; ipv6_decode() tries an
+      // IPv4 tail at offset 35 at most, after seven "h16:" groups.
+
+      constexpr std::size_t ipv4_lookahead = 12 + 8;
+      constexpr std::size_t ipv6_lookahead = 35 + ipv4_lookahead;
+
+      template< unsigned Bytes >
+      struct ip_value_tag
+      { };
+
+      template< unsigned Bytes, std::size_t Lookahead, std::size_t ( * Decode )( const char *, unsigned char * ) >
+      struct ip_binary
+      {
+         using analyze_t = analysis::generic< analysis::rule_type::ANY >;
+
+         // This is used to bind an action to the binary address.
+         using value = ip_value_tag< Bytes >;
+
+         using bytes = std::array< unsigned char, Bytes >;
+
+         static std::size_t decode( const char * data, const std::size_t size, bytes & address )
+         {
+            if ( size >= Lookahead ) {
+               return Decode( data, address.data() );
+            }
+            char buffer[ Lookahead ] = { 0 };
+            if ( size ) {
+               std::memcpy( buffer, data, size );
+            }
+            return Decode( buffer, address.data() );
+         }
+
+         template< apply_mode A, template< typename ... > class Action, typename ... States >
+         static typename std::enable_if< ( ( A == apply_mode::ACTION ) && ( ! is_nothing< Action, value >::value ) ) >::type
+         apply_value( const bytes & address, States && ... st )
+         {
+            Action< value >::apply( address, st ... );
+         }
+
+         template< apply_mode A, template< typename ... > class Action, typename ... States >
+         static typename std::enable_if< ! ( ( A == apply_mode::ACTION ) && ( ! is_nothing< Action, value >::value ) ) >::type
+         apply_value( const bytes &, States && ... )
+         { }
+
+         template< apply_mode A, template< typename ... > class Action, template< typename ... > class Control, typename Input, typename ... States >
+         static bool match( Input & in, States && ... st )
+         {
+            bytes address;
+            if ( const std::size_t n = decode( in.begin(), in.size( Lookahead ), address ) ) {
+               in.bump_in_this_line( n );
+               apply_value< A, Action >( address, st ... );
+               return true;
+            }
+            return false;
+         }
+      };
+
+   } // internal
+
+   namespace uri
+   {
+      // Rules that match the same as IPv4address and IPv6address, the
+      // latter when followed by the closing "]" of an IP_literal, and that
+      // decode the address in network byte order while matching; an action
+      // for IPv4binary::value or IPv6binary::value is called with a const
+      // reference to the ipv4_bytes or ipv6_bytes (instead of the input) and
+      // the states. Actions for the rules themselves are called as usual.
+
+      struct IPv4binary : internal::ip_binary< 4, internal::ipv4_lookahead, internal::ipv4_decode > {};
+      struct IPv6binary : internal::ip_binary< 16, internal::ipv6_lookahead, internal::ipv6_decode > {};
+
+      // Decode addresses that have to span all of data.
+
+      inline bool parse_ipv4( const char * data, const std::size_t size, ipv4_bytes & address )
+      {
+         return ( size != 0 ) && ( size <= 15 ) && ( IPv4binary::decode( data, size, address ) == size );
+      }
+
+      inline bool parse_ipv6( const char * data, const std::size_t size, ipv6_bytes & address )
+      {
+         return ( size != 0 ) && ( size <= 45 ) && ( IPv6binary::decode( data, size, address ) == size );
+      }
+
+   } // uri
+
+} // pegtl
+
+#endif
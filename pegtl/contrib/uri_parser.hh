@@ -0,0 +1,121 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_URI_PARSER_HH
+#define PEGTL_CONTRIB_URI_PARSER_HH
+
+#include <cstddef>
+
+#include "../parse.hh"
+#include "../nothing.hh"
+#include "../parse_error.hh"
+
+#include "uri.hh"
+#include "view.hh"
+
+namespace pegtl
+{
+   namespace uri
+   {
+      using pegtl::view;
+
+      // The components of a URI or relative reference as views of the input;
+      // components that are not present have a null data pointer, which is
+      // different from an empty component, e.g. the query of "http://a/?".
+      // The host of an IP literal includes the brackets.
+
+      struct parse_result
+      {
+         view scheme;
+         view userinfo;
+         view host;
+         view port;
+         view path;
+         view query;
+         view fragment;
+
+         bool has_authority() const
+         {
+            return host.data != nullptr;
+         }
+
+         void clear()
+         {
+            * this = parse_result();
+         }
+      };
+
+      // Actions that fill a parse_result; they take care of the rules that
+      // can succeed within an alternative that fails later.
+
+      template< typename Rule > struct parse_action : nothing< Rule > {};
+
+      template< view parse_result::* Component >
+      struct parse_component
+      {
+         template< typename Input >
+         static void apply( const Input & in, parse_result & r )
+         {
+            r.*Component = view( in.begin(), in.size() );
+         }
+      };
+
+      template<> struct parse_action< scheme > : parse_component< & parse_result::scheme > {};
+      template<> struct parse_action< userinfo > : parse_component< & parse_result::userinfo > {};
+      template<> struct parse_action< host > : parse_component< & parse_result::host > {};
+      template<> struct parse_action< port > : parse_component< & parse_result::port > {};
+      template<> struct parse_action< path_abempty > : parse_component< & parse_result::path > {};
+      template<> struct parse_action< path_absolute > : parse_component< & parse_result::path > {};
+      template<> struct parse_action< path_noscheme > : parse_component< & parse_result::path > {};
+      template<> struct parse_action< path_rootless > : parse_component< & parse_result::path > {};
+      template<> struct parse_action< path_empty > : parse_component< & parse_result::path > {};
+      template<> struct parse_action< query > : parse_component< & parse_result::query > {};
+      template<> struct parse_action< fragment > : parse_component< & parse_result::fragment > {};
+
+      // The userinfo also matches when it is not followed by "@", in which
+      // case the host starts at the beginning of the authority.
+
+      template<> struct parse_action< authority >
+      {
+         template< typename Input >
+         static void apply( const Input & in, parse_result & r )
+         {
+            if ( r.host.data == in.begin() ) {
+               r.userinfo = view();
+            }
+         }
+      };
+
+      // In a URI_reference the scheme matches before the URI fails on
+      // relative references like "a/b:c".
+
+      template<> struct parse_action< relative_ref >
+      {
+         template< typename Input >
+         static void apply( const Input &, parse_result & r )
+         {
+            r.scheme = view();
+         }
+      };
+
+      // Parses data, which has to match Rule completely, into r with a single
+      // pass and without copying any part of the input. Returns false for
+      // invalid input.
+
+      template< typename Rule = URI_reference >
+      bool parse_components( const char * data, const std::size_t size, parse_result & r )
+      {
+         r.clear();
+         try {
+            return parse_memory< seq< Rule, eof >, parse_action >( data, data + size, "uri", r );
+         }
+         catch ( const parse_error & ) {
+            return false;
+         }
+      }
+
+   } // uri
+
+} // pegtl
+
+#endif
@@ -0,0 +1,71 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_CONTRIB_VIEW_HH
+#define PEGTL_CONTRIB_VIEW_HH
+
+#include <string>
+#include <cstddef>
+
+namespace pegtl
+{
+   // A view of a part of the input; the input has to outlive all views
+   // that refer to it.
+
+   struct view
+   {
+      view()
+            : data( nullptr ),
+              size( 0 )
+      { }
+
+      view( const char * in_data, const std::size_t in_size )
+            : data( in_data ),
+              size( in_size )
+      { }
+
+      const char * data;
+      std::size_t size;
+
+      bool empty() const
+      {
+         return size == 0;
+      }
+
+      const char * begin() const
+      {
+         return data;
+      }
+
+      const char * end() const
+      {
+         return data + size;
+      }
+
+      std::string string() const
+      {
+         return std::string( data, size );
+      }
+
+      // ASCII case-insensitive comparison with a zero-terminated string.
+
+      bool iequal( const char * s ) const
+      {
+         for ( std::size_t i = 0; i < size; ++i, ++s ) {
+            if ( ( ! * s ) || ( lower( data[ i ] ) != lower( * s ) ) ) {
+               return false;
+            }
+         }
+         return ! * s;
+      }
+
+   private:
+      static char lower( const char c )
+      {
+         return ( ( c >= 'A' ) && ( c <= 'Z' ) ) ? char( c | 0x20 ) : c;
+      }
+   };
+
+} // pegtl
+
+#endif
@@ -46,12 +46,20 @@ namespace pegtl
          std::string read() const
          {
             std::string nrv;
-            nrv.resize( size() );
+            read( nrv );
+            return nrv;
+         }
+
+         // Reads the file into the given buffer, which allows the buffer's
+         // memory to be re-used when reading multiple files.
+
+         void read( std::string & buffer ) const
+         {
+            buffer.resize( size() );
             errno = 0;
-            if ( nrv.size() && ( std::fread( & nrv[ 0 ], nrv.size(), 1, m_file.get() ) != 1 ) ) {
-               PEGTL_THROW_INPUT_ERROR( "unable to fread() file " << m_source << " size " << nrv.size() );  // LCOV_EXCL_LINE
+            if ( buffer.size() && ( std::fread( & buffer[ 0 ], buffer.size(), 1, m_file.get() ) != 1 ) ) {
+               PEGTL_THROW_INPUT_ERROR( "unable to fread() file " << m_source << " size " << buffer.size() );  // LCOV_EXCL_LINE
             }
-            return nrv;
          }
 
       private:
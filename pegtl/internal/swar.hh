@@ -0,0 +1,103 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#ifndef PEGTL_INTERNAL_SWAR_HH
+#define PEGTL_INTERNAL_SWAR_HH
+
+#include <cstdint>
+#include <cstring>
+
+namespace pegtl
+{
+   namespace internal
+   {
+      // Helpers to process eight bytes at a time in a 64-bit integer
+      // (SWAR = SIMD within a register). The first byte of the input
+      // is always placed in the lowest byte of the integer.
+
+      // A single unaligned load on little-endian platforms, elsewhere the
+      // integer is assembled byte-wise.
+
+      inline std::uint64_t swar_load( const char * p )
+      {
+#if defined(__BYTE_ORDER__) && ( __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ )
+         std::uint64_t r;
+         std::memcpy( & r, p, 8 );
+         return r;
+#else
+         std::uint64_t r = 0;
+         for ( unsigned i = 0; i < 8; ++i ) {
+            r |= std::uint64_t( static_cast< unsigned char >( p[ i ] ) ) << ( 8 * i );
+         }
+         return r;
+#endif
+      }
+
+      constexpr std::uint64_t swar_broadcast( const unsigned char c )
+      {
+         return 0x0101010101010101ull * c;
+      }
+
+      // True iff at least one byte is less than N, for N <= 128.
+
+      template< unsigned char N >
+      constexpr bool swar_has_less( const std::uint64_t v )
+      {
+         return ( ( v - swar_broadcast( N ) ) & ~v & swar_broadcast( 0x80 ) ) != 0;
+      }
+
+      template< unsigned char C >
+      constexpr bool swar_has_byte( const std::uint64_t v )
+      {
+         return swar_has_less< 1 >( v ^ swar_broadcast( C ) );
+      }
+
+      constexpr bool swar_has_high_bit( const std::uint64_t v )
+      {
+         return ( v & swar_broadcast( 0x80 ) ) != 0;
+      }
+
+      // The high bit of every byte in [ Lo, Hi ] is set, all other bits
+      // are cleared, for 0 < Lo <= Hi < 128.
+
+      template< unsigned char Lo, unsigned char Hi >
+      constexpr std::uint64_t swar_in_range( const std::uint64_t v )
+      {
+         return ( ( v & swar_broadcast( 0x7f ) ) + swar_broadcast( 0x80 - Lo ) ) & ~( ( v & swar_broadcast( 0x7f ) ) + swar_broadcast( 0x7f - Hi ) ) & ~v & swar_broadcast( 0x80 );
+      }
+
+      // The high bit of every byte equal to one of the Cs is set, all other
+      // bits are cleared; unlike swar_has_byte() this is exact for every byte.
+
+      template< char C >
+      constexpr std::uint64_t swar_equal( const std::uint64_t v )
+      {
+         return ~( ( ( ( v ^ swar_broadcast( C ) ) & swar_broadcast( 0x7f ) ) + swar_broadcast( 0x7f ) ) | ( v ^ swar_broadcast( C ) ) ) & swar_broadcast( 0x80 );
+      }
+
+      template< char C, char D, char ... Cs >
+      constexpr std::uint64_t swar_equal( const std::uint64_t v )
+      {
+         return swar_equal< C >( v ) | swar_equal< D, Cs ... >( v );
+      }
+
+      constexpr std::uint64_t swar_hex_digits( const std::uint64_t v )
+      {
+         return swar_in_range< '0', '9' >( v ) | swar_in_range< 'a', 'f' >( v | swar_broadcast( 0x20 ) );
+      }
+
+      // The number of leading bytes, i.e. starting with the first byte,
+      // for which the high bit is set in a mask like those above.
+
+      inline unsigned swar_count_leading( const std::uint64_t m )
+      {
+         const std::uint64_t z = ~m & swar_broadcast( 0x80 );
+         const std::uint64_t below = ( ( z & ( ~z + 1 ) ) - 1 ) & swar_broadcast( 0x80 );
+         return unsigned( ( ( below >> 7 ) * swar_broadcast( 1 ) ) >> 56 );
+      }
+
+   } // internal
+
+} // pegtl
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <sstream>
+
+#include "test.hh"
+
+namespace pegtl
+{
+   namespace analyze_grammar_test
+   {
+      using analysis::rule_properties;
+
+      struct keyword : sor< string< 'i', 'n', 't' >, string< 'i', 'n' >, istring< 'f', 'o', 'r' > > {};
+      struct number : seq< opt< one< '-' > >, plus< digit >, opt< one< '.' >, rep_min_max< 1, 3, digit > > > {};
+      struct value;
+      struct array : seq< one< '[' >, opt< list< value, one< ',' > > >, one< ']' > > {};
+      struct value : sor< number, array > {};
+      struct comment : seq< two< '/' >, until< eolf > > {};
+      struct block : seq< string< '/', '*' >, until< seq< star< one< '*' > >, one< '/' > > > > {};
+      struct loop : star< seq< plus< alpha >, one< ';' > > > {};
+      struct never : seq< digit, failure > {};
+      struct grammar : seq< star< sor< keyword, value, comment, block, blank > >, opt< loop >, opt< never >, eof > {};
+
+      struct wide : utf8::range< 0x80, 0x7ff > {};
+
+      template< typename Rule >
+      const rule_properties & get( const analysis::analyze_grammar< grammar > & a )
+      {
+         return a.get< Rule >();
+      }
+
+      bool has_warning( const analysis::analyze_grammar< grammar > & a, const std::string & kind, const std::string & rule )
+      {
+         for ( const auto & w : a.warnings() ) {
+            if ( ( w.kind == kind ) && ( w.rule == rule ) ) {
+               return true;
+            }
+         }
+         return false;
+      }
+
+   } // analyze_grammar_test
+
+   void unit_test()
+   {
+      using namespace analyze_grammar_test;
+
+      const analysis::analyze_grammar< grammar > a;
+
+      const auto & k = get< keyword >( a );
+      TEST_ASSERT( k.kind == analysis::rule_kind::CHOICE );
+      TEST_ASSERT( ! k.nullable );
+      TEST_ASSERT( k.min_length == 2 );
+      TEST_ASSERT( k.max_length == 3 );
+      TEST_ASSERT( k.first.count() == 3 );
+      TEST_ASSERT( k.first.test( 'i' ) && k.first.test( 'f' ) && k.first.test( 'F' ) );
+
+      const auto & n = get< number >( a );
+      TEST_ASSERT( ! n.nullable );
+      TEST_ASSERT( n.min_length == 1 );
+      TEST_ASSERT( n.max_length == rule_properties::unbounded );
+      TEST_ASSERT( n.first.count() == 11 );
+
+      TEST_ASSERT( ( get< rep_min_max< 1, 3, digit > >( a ).min_length == 1 ) );
+      TEST_ASSERT( ( get< rep_min_max< 1, 3, digit > >( a ).max_length == 3 ) );
+
+      const auto & v = get< value >( a );
+      TEST_ASSERT( v.min_length == 1 );
+      TEST_ASSERT( v.max_length == rule_properties::unbounded );
+      TEST_ASSERT( v.first.count() == 12 );
+      TEST_ASSERT( get< array >( a ).min_length == 2 );
+
+      const auto & c = get< comment >( a );
+      TEST_ASSERT( c.min_length == 2 );
+      TEST_ASSERT( c.max_length == rule_properties::unbounded );
+      TEST_ASSERT( c.first.count() == 1 );
+
+      TEST_ASSERT( get< eof >( a ).kind == analysis::rule_kind::PREDICATE );
+      TEST_ASSERT( get< eof >( a ).nullable );
+      TEST_ASSERT( get< eof >( a ).first.none() );
+      TEST_ASSERT( ! get< never >( a ).can_succeed() );
+      TEST_ASSERT( get< grammar >( a ).nullable );
+
+      TEST_ASSERT( has_warning( a, "sor-overlap", internal::demangle< keyword >() ) );
+      TEST_ASSERT( ! has_warning( a, "sor-overlap", internal::demangle< value >() ) );
+      TEST_ASSERT( has_warning( a, "loop-unbounded-body", internal::demangle< loop >() ) );
+      TEST_ASSERT( ! has_warning( a, "loop-unbounded-body", internal::demangle< plus< alpha > >() ) );
+      TEST_ASSERT( has_warning( a, "until-overlap", internal::demangle< until< seq< star< one< '*' > >, one< '/' > > > >() ) );
+      TEST_ASSERT( ! has_warning( a, "until-overlap", internal::demangle< until< eolf > >() ) );
+      TEST_ASSERT( has_warning( a, "sor-overlap", internal::demangle< sor< keyword, value, comment, block, blank > >() ) );
+      TEST_ASSERT( ! has_warning( a, "loop-unbounded-body", internal::demangle< internal::star< one< ',' >, value > >() ) );
+      TEST_ASSERT( a.warnings().size() == 5 );
+
+      const analysis::analyze_grammar< wide > w;
+      TEST_ASSERT( w.get< wide >().min_length == 2 );
+      TEST_ASSERT( w.get< wide >().max_length == 2 );
+      TEST_ASSERT( w.get< wide >().first.count() == 30 );
+      TEST_ASSERT( w.get< wide >().first.test( 0xc2 ) && w.get< wide >().first.test( 0xdf ) );
+
+      const analysis::analyze_grammar< seq< not_at< one< '\\' > >, any > > g;
+      TEST_ASSERT( ( g.get< seq< not_at< one< '\\' > >, any > >().first.count() == 255 ) );
+      TEST_ASSERT( ( ! g.get< seq< not_at< one< '\\' > >, any > >().first.test( '\\' ) ) );
+
+      const analysis::analyze_grammar< star< opt< digit > > > s;
+      TEST_ASSERT( s.warnings().size() == 1 );
+      TEST_ASSERT( s.warnings()[ 0 ].kind == "loop-nullable-body" );
+
+      TEST_ASSERT( analysis::analyze_grammar_impl::character_class( k.first ) == "[Ffi]" );
+      TEST_ASSERT( analysis::analyze_grammar_impl::character_class( n.first ) == "[\\-0-9]" );
+
+      std::ostringstream o;
+      TEST_ASSERT( analyze_report< grammar >( o ) == 5 );
+      TEST_ASSERT( o.str().find( "\"kind\": \"sor-overlap\"" ) != std::string::npos );
+      TEST_ASSERT( o.str().find( "\"first\": \"[i]\"" ) != std::string::npos );
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,51 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include "test.hh"
+
+namespace pegtl
+{
+   namespace buffer_stats_test
+   {
+      struct pairs : seq< string< 'a', 'b' >, discard, string< 'c', 'd' >, discard, string< 'e', 'f' >, discard, eof > {};
+      struct moved : seq< at< string< 'a', 'b' > >, one< 'a' >, discard, string< 'b', 'c' >, eof > {};
+
+   } // buffer_stats_test
+
+   void unit_test()
+   {
+      {
+         buffer_input< internal::cstring_reader > in( "pairs", 2, "abcdef" );
+         TEST_ASSERT( in.stats().reader_calls == 0 );
+         TEST_ASSERT( parse_input< buffer_stats_test::pairs >( in ) );
+         const auto & s = in.stats();
+         TEST_ASSERT( s.maximum_buffered == 2 );
+         TEST_ASSERT( s.reader_calls == 4 );
+         TEST_ASSERT( s.requested_bytes == 7 );
+         TEST_ASSERT( s.read_bytes == 6 );
+         TEST_ASSERT( s.discards == 3 );
+         TEST_ASSERT( s.moved_bytes == 0 );
+         TEST_ASSERT( ! s.maximum_reached );
+      }
+      {
+         buffer_input< internal::cstring_reader > in( "pairs", 1, "abcdef" );
+         TEST_ASSERT( ! parse_input< buffer_stats_test::pairs >( in ) );
+         TEST_ASSERT( in.stats().reader_calls == 0 );
+         TEST_ASSERT( in.stats().maximum_reached );
+      }
+      {
+         buffer_input< internal::cstring_reader > in( "moved", 3, "abc" );
+         TEST_ASSERT( parse_input< buffer_stats_test::moved >( in ) );
+         const auto & s = in.stats();
+         TEST_ASSERT( s.maximum_buffered == 2 );
+         TEST_ASSERT( s.reader_calls == 3 );
+         TEST_ASSERT( s.read_bytes == 3 );
+         TEST_ASSERT( s.discards == 1 );
+         TEST_ASSERT( s.moved_bytes == 1 );
+         TEST_ASSERT( ! s.maximum_reached );
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,63 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <sstream>
+
+#include "test.hh"
+
+#include <pegtl/contrib/backtrack_profiler.hh>
+
+namespace pegtl
+{
+   namespace backtrack_test
+   {
+      // The first alternative consumes "abc" before failing on "abd".
+
+      struct abc : seq< one< 'a' >, one< 'b' >, one< 'c' > > {};
+      struct abd : seq< one< 'a' >, one< 'b' >, one< 'd' > > {};
+      struct alternative : sor< abc, abd > {};
+      struct grammar : seq< plus< alternative >, eof > {};
+
+   } // backtrack_test
+
+   void unit_test()
+   {
+      const std::string data = "abcabdabd";
+      backtrack_profile::reset( data.data(), 3 );
+
+      TEST_ASSERT( ( parse_string< backtrack_test::grammar, nothing, backtrack_profiler >( data, __FILE__ ) ) );
+
+      const auto & abc = backtrack_profile::entries()[ internal::rule_id< backtrack_test::abc >::value ];
+      TEST_ASSERT( abc.failure == 2 );
+      TEST_ASSERT( abc.wasted_failure == 2 );
+      TEST_ASSERT( abc.wasted == 4 );
+      TEST_ASSERT( abc.maximum == 2 );
+
+      const auto & alternative = backtrack_profile::entries()[ internal::rule_id< backtrack_test::alternative >::value ];
+      TEST_ASSERT( alternative.failure == 0 );
+
+      const auto & h = backtrack_profile::heatmap();
+      TEST_ASSERT( h.size() == 4 );
+      TEST_ASSERT( h[ 0 ] == 7 );
+      TEST_ASSERT( h[ 1 ] == 9 );
+      TEST_ASSERT( h[ 2 ] == 9 );
+      TEST_ASSERT( h[ 3 ] == 1 );
+
+      std::ostringstream o;
+      backtrack_profile::report( o );
+      TEST_ASSERT( o.str().find( "pegtl::backtrack_test::abc\n" ) != std::string::npos );
+      TEST_ASSERT( o.str().find( "pegtl::backtrack_test::abd\n" ) == std::string::npos );
+
+      std::ostringstream p;
+      backtrack_profile::report_heatmap( p, 1 );
+      TEST_ASSERT( p.str().find( "             3             9\n" ) != std::string::npos );
+
+      backtrack_profile::reset();
+      TEST_ASSERT( backtrack_profile::heatmap().empty() );
+      TEST_ASSERT( backtrack_profile::entries()[ internal::rule_id< backtrack_test::abc >::value ].failure == 0 );
+   }
+
+} // pegtl
+
+#include "main.hh"
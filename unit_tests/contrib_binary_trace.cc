@@ -0,0 +1,73 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include "test.hh"
+
+#include <pegtl/contrib/binary_trace.hh>
+
+namespace pegtl
+{
+   namespace binary_trace_test
+   {
+      struct a : one< 'a' > {};
+      struct b : one< 'b' > {};
+      struct grammar : seq< a, must< b > > {};
+
+   } // binary_trace_test
+
+   void unit_test()
+   {
+      binary_trace::reset( 5 );
+
+      TEST_ASSERT( ( parse_string< binary_trace_test::grammar, nothing, binary_tracer >( "ab", __FILE__ ) ) );
+      {
+         // grammar, a, a, must< b >, b, b, must< b >, grammar; the ring buffer holds the last eight.
+         const auto r = binary_trace::records();
+         TEST_ASSERT( r.size() == 8 );
+         TEST_ASSERT( r[ 0 ].rule == internal::rule_id< binary_trace_test::grammar >::value );
+         TEST_ASSERT( r[ 0 ].event == trace_event::START );
+         TEST_ASSERT( r[ 2 ].rule == internal::rule_id< binary_trace_test::a >::value );
+         TEST_ASSERT( r[ 2 ].event == trace_event::SUCCESS );
+         TEST_ASSERT( r[ 2 ].byte_in_line == 1 );
+         TEST_ASSERT( r[ 7 ].event == trace_event::SUCCESS );
+         TEST_ASSERT( r[ 7 ].byte_in_line == 2 );
+      }
+      binary_trace::reset( 4 );
+
+      try {
+         parse_string< binary_trace_test::grammar, nothing, binary_tracer >( "aa", __FILE__ );
+         TEST_ASSERT( false );
+      }
+      catch ( const parse_error & ) {
+      }
+      const auto r = binary_trace::records();
+      TEST_ASSERT( r.size() == 4 );
+      TEST_ASSERT( r[ 3 ].event == trace_event::RAISE );
+      TEST_ASSERT( r[ 3 ].rule == internal::rule_id< binary_trace_test::b >::value );
+      TEST_ASSERT( r[ 2 ].event == trace_event::FAILURE );
+
+      std::stringstream s;
+      binary_trace::write( s );
+      std::vector< std::string > names;
+      std::vector< trace_record > records;
+      TEST_ASSERT( binary_trace::read( s, names, records ) );
+      TEST_ASSERT( names.size() == internal::rule_registry::size() );
+      TEST_ASSERT( names[ internal::rule_id< binary_trace_test::b >::value ] == "pegtl::binary_trace_test::b" );
+      TEST_ASSERT( records.size() == r.size() );
+      for ( std::size_t i = 0; i < r.size(); ++i ) {
+         TEST_ASSERT( records[ i ].rule == r[ i ].rule );
+         TEST_ASSERT( records[ i ].event == r[ i ].event );
+         TEST_ASSERT( records[ i ].line == r[ i ].line );
+         TEST_ASSERT( records[ i ].byte_in_line == r[ i ].byte_in_line );
+      }
+      std::stringstream t( s.str().substr( 0, s.str().size() - 1 ) );
+      TEST_ASSERT( ! binary_trace::read( t, names, records ) );
+   }
+
+} // pegtl
+
+#include "main.hh"
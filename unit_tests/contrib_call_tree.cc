@@ -0,0 +1,63 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <sstream>
+
+#include "test.hh"
+
+#include <pegtl/contrib/call_tree.hh>
+
+namespace pegtl
+{
+   namespace call_tree_test
+   {
+      struct ws : one< ' ' > {};
+      struct a : seq< one< 'a' >, star< ws > > {};
+      struct b : seq< one< 'b' >, star< ws > > {};
+      struct grammar : seq< star< ws >, plus< sor< a, b > >, eof > {};
+
+   } // call_tree_test
+
+   void unit_test()
+   {
+      call_tree::reset();
+      TEST_ASSERT( ( parse_string< call_tree_test::grammar, nothing, call_tree_profiler >( " a  b a", __FILE__ ) ) );
+
+      std::ostringstream o;
+      call_tree::write_folded( o, call_tree::metric::COUNT );
+      const std::string r = o.str();
+
+      const std::string g = "pegtl::call_tree_test::grammar";
+      const std::string s = "pegtl::sor<pegtl::call_tree_test::a, pegtl::call_tree_test::b>";
+      const std::string p = "pegtl::plus<" + s + ">";
+      const std::string ws = "pegtl::star<pegtl::call_tree_test::ws>";
+
+      TEST_ASSERT( r.find( g + " 1\n" ) != std::string::npos );
+      TEST_ASSERT( r.find( g + ";" + ws + " 1\n" ) != std::string::npos );
+      TEST_ASSERT( r.find( g + ";" + ws + ";pegtl::call_tree_test::ws 2\n" ) != std::string::npos );
+      TEST_ASSERT( r.find( g + ";" + p + ";" + s + ";pegtl::call_tree_test::a " ) != std::string::npos );
+      TEST_ASSERT( r.find( g + ";" + p + ";" + s + ";pegtl::call_tree_test::a;" + ws + ";pegtl::call_tree_test::ws 3\n" ) != std::string::npos );
+
+      std::ostringstream q;
+      call_tree::write_folded( q, call_tree::metric::BYTES );
+      TEST_ASSERT( q.str().find( g + " 7\n" ) != std::string::npos );
+      TEST_ASSERT( q.str().find( g + ";" + p + ";" + s + ";pegtl::call_tree_test::b 2\n" ) != std::string::npos );
+
+      const auto & n = call_tree::nodes();
+      TEST_ASSERT( n[ 0 ].children.size() == 1 );
+      const auto & root = n[ n[ 0 ].children[ 0 ] ];
+      TEST_ASSERT( root.inclusive >= root.exclusive );
+      std::uint64_t children = 0;
+      for ( const auto c : root.children ) {
+         children += n[ c ].inclusive;
+      }
+      TEST_ASSERT( root.exclusive + children == root.inclusive );
+
+      call_tree::reset();
+      TEST_ASSERT( call_tree::nodes().size() == 1 );
+   }
+
+} // pegtl
+
+#include "main.hh"
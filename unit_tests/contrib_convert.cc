@@ -0,0 +1,168 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <random>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <clocale>
+
+#include "test.hh"
+
+#include <pegtl/contrib/json.hh>
+#include <pegtl/contrib/convert.hh>
+
+namespace pegtl
+{
+   template< typename I >
+   void verify_integer( const std::size_t line, const char * file, const std::string & s, const bool ok, const I expected = I() )
+   {
+      I result = I();
+      const bool r = convert::to_integer( s.data(), s.data() + s.size(), result );
+      if ( ( r != ok ) || ( ok && ( result != expected ) ) ) {
+         std::cerr << "pegtl: unit test failed for [ " << s << " ] in line [ " << line << " ] file [ " << file << " ]" << std::endl;
+         ++failed;
+      }
+   }
+
+   void verify_double( const std::size_t line, const char * file, const std::string & s )
+   {
+      double result = 0.0;
+      const double expected = std::strtod( s.c_str(), nullptr );
+      const bool r = convert::to_double( s.data(), s.data() + s.size(), result );
+      if ( std::isinf( expected ) ? r : ( ( ! r ) || ( std::memcmp( & result, & expected, sizeof( double ) ) != 0 ) ) ) {
+         std::cerr << "pegtl: unit test failed for [ " << s << " ] in line [ " << line << " ] file [ " << file << " ]" << std::endl;
+         ++failed;
+      }
+   }
+
+   template< typename Rule > struct int_action : nothing< Rule > {};
+   template<> struct int_action< plus< digit > > : convert::integer {};
+
+   template< typename Rule > struct double_action : nothing< Rule > {};
+   template<> struct double_action< json::number > : convert::floating {};
+
+   void unit_test()
+   {
+      verify_integer< int >( __LINE__, __FILE__, "0", true, 0 );
+      verify_integer< int >( __LINE__, __FILE__, "-0", true, 0 );
+      verify_integer< int >( __LINE__, __FILE__, "+42", true, 42 );
+      verify_integer< int >( __LINE__, __FILE__, "-42", true, -42 );
+      verify_integer< int >( __LINE__, __FILE__, "2147483647", true, 2147483647 );
+      verify_integer< int >( __LINE__, __FILE__, "-2147483648", true, -2147483647 - 1 );
+      verify_integer< int >( __LINE__, __FILE__, "2147483648", false );
+      verify_integer< int >( __LINE__, __FILE__, "-2147483649", false );
+      verify_integer< int >( __LINE__, __FILE__, "", false );
+      verify_integer< int >( __LINE__, __FILE__, "-", false );
+      verify_integer< int >( __LINE__, __FILE__, "12a", false );
+      verify_integer< unsigned char >( __LINE__, __FILE__, "255", true, 255 );
+      verify_integer< unsigned char >( __LINE__, __FILE__, "256", false );
+      verify_integer< unsigned >( __LINE__, __FILE__, "-1", false );
+      verify_integer< unsigned >( __LINE__, __FILE__, "-0", true, 0 );
+      verify_integer< std::int64_t >( __LINE__, __FILE__, "9223372036854775807", true, 9223372036854775807ll );
+      verify_integer< std::int64_t >( __LINE__, __FILE__, "-9223372036854775808", true, -9223372036854775807ll - 1 );
+      verify_integer< std::int64_t >( __LINE__, __FILE__, "9223372036854775808", false );
+      verify_integer< std::uint64_t >( __LINE__, __FILE__, "18446744073709551615", true, 18446744073709551615ull );
+      verify_integer< std::uint64_t >( __LINE__, __FILE__, "18446744073709551616", false );
+      verify_integer< std::uint64_t >( __LINE__, __FILE__, "00000000000000000000000000001", true, 1 );
+      verify_integer< std::uint64_t >( __LINE__, __FILE__, "1234567812345678", true, 1234567812345678ull );
+      verify_integer< std::uint64_t >( __LINE__, __FILE__, "123456781234567x", false );
+
+      verify_double( __LINE__, __FILE__, "0" );
+      verify_double( __LINE__, __FILE__, "-0" );
+      verify_double( __LINE__, __FILE__, "-0.0e5" );
+      verify_double( __LINE__, __FILE__, "1" );
+      verify_double( __LINE__, __FILE__, "-1.5" );
+      verify_double( __LINE__, __FILE__, "0.1" );
+      verify_double( __LINE__, __FILE__, "0.3" );
+      verify_double( __LINE__, __FILE__, "3.141592653589793" );
+      verify_double( __LINE__, __FILE__, "1e22" );
+      verify_double( __LINE__, __FILE__, "1e23" );
+      verify_double( __LINE__, __FILE__, "12e30" );
+      verify_double( __LINE__, __FILE__, "1E-22" );
+      verify_double( __LINE__, __FILE__, "1e-23" );
+      verify_double( __LINE__, __FILE__, "9007199254740993" );
+      verify_double( __LINE__, __FILE__, "9007199254740992" );
+      verify_double( __LINE__, __FILE__, "123456789012345678901234567890" );
+      verify_double( __LINE__, __FILE__, "0.000000000000000000000000000001" );
+      verify_double( __LINE__, __FILE__, "2.2250738585072011e-308" );
+      verify_double( __LINE__, __FILE__, "4.9e-324" );
+      verify_double( __LINE__, __FILE__, "1e-400" );
+      verify_double( __LINE__, __FILE__, "1.7976931348623157e308" );
+      verify_double( __LINE__, __FILE__, "1e+0000000000000000000000000000001" );
+      verify_double( __LINE__, __FILE__, "0.30000000000000004" );
+      verify_double( __LINE__, __FILE__, "-0.30000000000000004e-5" );
+      verify_double( __LINE__, __FILE__, "2.2250738585072012e-308" );
+      verify_double( __LINE__, __FILE__, "2.2250738585072014e-308" );
+      verify_double( __LINE__, __FILE__, "2.4703282292062327e-324" );
+      verify_double( __LINE__, __FILE__, "2.4703282292062328e-324" );
+      verify_double( __LINE__, __FILE__, "1.7976931348623158e308" );
+      verify_double( __LINE__, __FILE__, "9007199254740993.0000000000000000000000000000000000001" );
+      verify_double( __LINE__, __FILE__, "9007199254740993." + std::string( 1000, '0' ) + "1" );
+      verify_double( __LINE__, __FILE__, "0." + std::string( 400, '0' ) + "1e400" );
+      verify_double( __LINE__, __FILE__, "123456789012345678901234567890e-330" );
+      verify_double( __LINE__, __FILE__, "7.2057594037927933e16" );
+      verify_double( __LINE__, __FILE__, "1e-324" );
+      verify_double( __LINE__, __FILE__, "1e308" );
+
+      std::mt19937_64 random( 42 );
+      for ( unsigned i = 0; i < 100000; ++i ) {
+         const std::string s = std::to_string( random() ) + std::to_string( random() % 1000 ) + 'e' + std::to_string( int( random() % 700 ) - 360 );
+         verify_double( __LINE__, __FILE__, s.substr( random() % 8 ) );
+      }
+      for ( unsigned i = 0; i < 100000; ++i ) {
+         // The 17 digit representations of random doubles, which take the Eisel-Lemire path.
+         const std::uint64_t bits = random();
+         double x;
+         std::memcpy( & x, & bits, sizeof( x ) );
+         if ( std::isfinite( x ) ) {
+            char buffer[ 32 ];
+            std::snprintf( buffer, sizeof( buffer ), "%.17g", x );
+            verify_double( __LINE__, __FILE__, buffer );
+            std::snprintf( buffer, sizeof( buffer ), "%.17g", double( random() >> 11 ) * 1e-10 );
+            verify_double( __LINE__, __FILE__, buffer );
+         }
+      }
+      {
+         std::uint64_t h, l;
+         convert::multiply( ~std::uint64_t( 0 ), ~std::uint64_t( 0 ), h, l );
+         TEST_ASSERT( h == 0xfffffffffffffffe );
+         TEST_ASSERT( l == 1 );
+         convert::multiply( 0x123456789abcdef0, 0x0fedcba987654321, h, l );
+         TEST_ASSERT( h == 0x0121fa00ad77d742 );
+         TEST_ASSERT( l == 0x2236d88fe5618cf0 );
+         TEST_ASSERT( convert::leading_zeros( 1 ) == 63 );
+         TEST_ASSERT( convert::leading_zeros( ~std::uint64_t( 0 ) ) == 0 );
+      }
+
+      double d;
+      const std::string big = "1e400";
+      TEST_ASSERT( ! convert::to_double( big.data(), big.data() + big.size(), d ) );
+
+      if ( std::setlocale( LC_NUMERIC, "de_DE.UTF-8" ) ) {
+         const std::string slow = "0.30000000000000004";
+         TEST_ASSERT( convert::to_double( slow.data(), slow.data() + slow.size(), d ) );
+         TEST_ASSERT( d == 0.1 + 0.2 );
+         std::setlocale( LC_NUMERIC, "C" );
+      }
+
+      convert::state< int > is;
+      TEST_ASSERT( ( parse_string< plus< digit >, int_action >( "12345", __FUNCTION__, is ) ) );
+      TEST_ASSERT( is.converted == 12345 );
+
+      convert::state< double > ds;
+      TEST_ASSERT( ( parse_string< json::number, double_action >( "-12.5e-1", __FUNCTION__, ds ) ) );
+      TEST_ASSERT( ds.converted == -1.25 );
+
+      convert::state< unsigned char > cs;
+      try {
+         parse_string< plus< digit >, int_action >( "1000", __FUNCTION__, cs );
+         TEST_ASSERT( false );
+      }
+      catch ( const parse_error & ) {
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,109 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <vector>
+
+#include "test.hh"
+
+#include <pegtl/analyze.hh>
+#include <pegtl/contrib/csv.hh>
+
+namespace pegtl
+{
+   namespace csv_test
+   {
+      // Every row as its fields in brackets, one row per line; quoted
+      // fields are unescaped and marked with a '*'.
+
+      template< typename Dialect >
+      struct collect
+      {
+         std::string & result;
+
+         void operator() ( const std::vector< csv::field_view > & fields )
+         {
+            std::string s;
+            for ( const auto & f : fields ) {
+               csv::unescape< Dialect >( f, s );
+               result += ( f.quoted ? "*[" : "[" ) + s + ']';
+            }
+            result += '\n';
+         }
+      };
+
+      template< typename Dialect = csv::rfc4180 >
+      std::string rows( const std::string & in )
+      {
+         std::string result;
+         auto h = csv::make_row_handler( collect< Dialect >{ result } );
+         try {
+            if ( ! parse_string< csv::file< Dialect >, csv::row_action >( in, "csv", h ) ) {
+               return "failed";
+            }
+         }
+         catch ( const parse_error & ) {
+            return "error";
+         }
+         return result;
+      }
+
+   } // csv_test
+
+   void unit_test()
+   {
+      using namespace csv_test;
+
+      TEST_ASSERT( ! analyze< csv::file<> >() );
+      TEST_ASSERT(( ! analyze< csv::file< csv::dialect< '\t', '\'', '\\' > > >() ));
+
+      TEST_ASSERT( rows( "" ) == "" );
+      TEST_ASSERT( rows( "a" ) == "[a]\n" );
+      TEST_ASSERT( rows( "a,b,c\r\nd,e,f\r\n" ) == "[a][b][c]\n[d][e][f]\n" );
+      TEST_ASSERT( rows( "a,b\nc,d" ) == "[a][b]\n[c][d]\n" );
+      TEST_ASSERT( rows( ",,\n\n" ) == "[][][]\n[]\n" );
+      TEST_ASSERT( rows( "\"a,b\",\"c\r\nd\",\"e \"\"f\"\"\"\r\n" ) == "*[a,b]*[c\r\nd]*[e \"f\"]\n" );
+      TEST_ASSERT( rows( "\"\",x" ) == "*[][x]\n" );
+      TEST_ASSERT( rows( "one field that is longer than eight bytes,and another one\n" ) == "[one field that is longer than eight bytes][and another one]\n" );
+
+      TEST_ASSERT( rows( "\"abc" ) == "error" );
+      TEST_ASSERT( rows( "a\"b\n" ) == "error" );
+      TEST_ASSERT( rows( "\"a\"b\n" ) == "error" );
+      TEST_ASSERT( rows( "a\rb\n" ) == "error" );
+
+      using tsv = csv::dialect< '\t', '\'', '\\' >;
+
+      TEST_ASSERT( rows< tsv >( "a\tb,c\t'd\\'e\\\\'\n" ) == "[a][b,c]*[d'e\\]\n" );
+      TEST_ASSERT( rows< tsv >( "'a''b'\n" ) == "error" );
+      TEST_ASSERT( rows< tsv >( "'a\\" ) == "error" );
+
+      {
+         std::string result;
+         auto h = csv::make_row_handler( collect< csv::rfc4180 >{ result } );
+         const std::string in = "x,\"multi\nline\"\r\n" + std::string( 100, 'y' ) + ",z\n";
+         memory_input m( 1, 0, in.data(), in.data() + in.size(), "csv" );
+         TEST_ASSERT(( parse_input< csv::file<>, csv::row_action >( m, h ) ));
+         TEST_ASSERT( m.line() == 4 );
+         TEST_ASSERT( result == "[x]*[multi\nline]\n[" + std::string( 100, 'y' ) + "][z]\n" );
+      }
+      {
+         std::string in;
+         std::string expected;
+         for ( unsigned i = 0; i < 100; ++i ) {
+            const std::string s = std::to_string( i );
+            in += s + ",\"" + s + "\"\"\"\r\n";
+            expected += '[' + s + "]*[" + s + "\"]\n";
+         }
+         std::string result;
+         auto h = csv::make_row_handler( collect< csv::rfc4180 >{ result } );
+         buffer_input< internal::cstring_reader > b( "csv", 32, in.c_str() );
+         TEST_ASSERT(( parse_input< csv::file<>, csv::row_action >( b, h ) ));
+         TEST_ASSERT( result == expected );
+         TEST_ASSERT( b.stats().discards == 100 );
+         TEST_ASSERT( b.stats().maximum_buffered <= 32 );
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,122 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include "test.hh"
+
+#include <pegtl/contrib/deferred.hh>
+
+namespace pegtl
+{
+   namespace test1
+   {
+      struct a : one< 'a' > {};
+      struct b : one< 'b' > {};
+      struct c : one< 'c' > {};
+      struct ab : seq< a, b > {};
+      struct ac : seq< a, c > {};
+      struct abc : sor< ab, ac > {};
+      struct grammar : seq< plus< abc >, eof > {};
+
+      struct committed : seq< commit< abc >, one< ';' > > {};
+      struct grammar2 : seq< plus< committed >, eof > {};
+      struct grammar3 : seq< commit< ab >, ac > {};
+
+      template< typename Rule > struct action : nothing< Rule > {};
+
+      template< typename Rule >
+      struct record_action
+      {
+         static void apply( const action_input & in, std::string & st )
+         {
+            st += '(';
+            st += in.string();
+            st += ')';
+         }
+      };
+
+      template<> struct action< a > : record_action< a > {};
+      template<> struct action< ab > : record_action< ab > {};
+      template<> struct action< ac > : record_action< ac > {};
+
+      template< typename Rule > struct semicolon_action : action< Rule > {};
+
+      template<>
+      struct semicolon_action< one< ';' > >
+      {
+         static void apply( const action_input &, std::string & st )
+         {
+            st += ';';
+         }
+      };
+
+      void test_deferred()
+      {
+         std::string st;
+         TEST_ASSERT( ( parse_string< grammar, action >( "acab", __FUNCTION__, st ) ) );
+         TEST_ASSERT( st == "(a)(a)(ac)(a)(ab)" );
+
+         std::string dt;
+         memory_input in( 1, 0, "acab", "acab" + 4, __FUNCTION__ );
+         TEST_ASSERT( ( parse_input_deferred< grammar, action >( in, dt ) ) );
+         TEST_ASSERT( dt == "(a)(ac)(a)(ab)" );
+         TEST_ASSERT( in.empty() );
+      }
+
+      void test_failure()
+      {
+         std::string dt;
+         memory_input in( 1, 0, "acax", "acax" + 4, __FUNCTION__ );
+         TEST_ASSERT( ! ( parse_input_deferred< grammar, action >( in, dt ) ) );
+         TEST_ASSERT( dt.empty() );
+      }
+
+      void test_commit()
+      {
+         std::string dt;
+         memory_input in( 1, 0, "ac;ab;", "ac;ab;" + 6, __FUNCTION__ );
+         TEST_ASSERT( ( parse_input_deferred< grammar2, semicolon_action >( in, dt ) ) );
+         TEST_ASSERT( dt == "(a)(ac);(a)(ab);" );
+
+         std::string ft;
+         memory_input fi( 1, 0, "abab", "abab" + 4, __FUNCTION__ );
+         TEST_ASSERT( ! ( parse_input_deferred< grammar3, action >( fi, ft ) ) );
+         TEST_ASSERT( ft == "(a)(ab)" );
+      }
+
+      void test_tape()
+      {
+         std::string dt;
+         memory_input in( 1, 0, "ab", "ab" + 2, __FUNCTION__ );
+         deferred_input< memory_input, std::string > di( in );
+         {
+            auto m = di.mark();
+            di.tape().record< action< a > >( 1, 0, in.begin(), in.begin() + 1 );
+            TEST_ASSERT( di.tape().size() == 1 );
+         }
+         TEST_ASSERT( di.tape().empty() );
+         {
+            auto m = di.mark();
+            di.tape().record< action< a > >( 1, 0, in.begin(), in.begin() + 1 );
+            di.tape().record< action< ab > >( 1, 0, in.begin(), in.begin() + 2 );
+            m( true );
+         }
+         TEST_ASSERT( di.tape().size() == 2 );
+         di.tape().replay( dt );
+         TEST_ASSERT( di.tape().empty() );
+         TEST_ASSERT( di.tape().position() == 2 );
+         TEST_ASSERT( dt == "(a)(ab)" );
+      }
+
+   } // test1
+
+   void unit_test()
+   {
+      test1::test_deferred();
+      test1::test_failure();
+      test1::test_commit();
+      test1::test_tape();
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,116 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <cctype>
+#include <cstring>
+
+#include "test.hh"
+
+#include <pegtl/contrib/http_headers.hh>
+
+namespace pegtl
+{
+   namespace http_headers_test
+   {
+      http::known_header classify( const std::string & name )
+      {
+         return http::classify_header( name.data(), name.size() );
+      }
+
+      bool value( const http::known_header h, const std::string & v )
+      {
+         return http::parse_header_value( h, v.data(), v.size() );
+      }
+
+      template< typename Rule > struct count_action : nothing< Rule > {};
+
+      template<> struct count_action< http::transfer_coding >
+      {
+         template< typename Input >
+         static void apply( const Input &, unsigned & n )
+         {
+            ++n;
+         }
+      };
+
+      struct field : seq< http::field_name, one< ':' > > {};
+
+      struct fields : seq< star< http::typed_header_field, abnf::CRLF >, abnf::CRLF, eof > {};
+
+      template< typename Rule > struct typed_action : nothing< Rule > {};
+
+      template< http::known_header H > struct typed_action< http::header_value< H > >
+      {
+         template< typename Input >
+         static void apply( const Input & in, std::string & s )
+         {
+            s += std::to_string( unsigned( H ) ) + '=' + in.string() + ';';
+         }
+      };
+
+      std::string typed( const std::string & in )
+      {
+         std::string s;
+         return parse_string< fields, typed_action >( in, "test", s ) ? s : "invalid";
+      }
+
+   } // http_headers_test
+
+   void unit_test()
+   {
+      using namespace http_headers_test;
+
+      for ( unsigned i = 1; i <= unsigned( http::known_header::X_REQUEST_ID ); ++i ) {
+         const http::known_header h = http::known_header( i );
+         std::string name = http::known_header_name( h );
+         TEST_ASSERT( classify( name ) == h );
+         for ( auto & c : name ) {
+            c = char( std::toupper( c ) );
+         }
+         TEST_ASSERT( classify( name ) == h );
+         TEST_ASSERT( classify( name.substr( 1 ) ) != h );
+         TEST_ASSERT( classify( name + "s" ) != h );
+      }
+      TEST_ASSERT( classify( "Content-Length" ) == http::known_header::CONTENT_LENGTH );
+      TEST_ASSERT( classify( "Content_Length" ) == http::known_header::UNKNOWN );
+      TEST_ASSERT( classify( "X-Custom" ) == http::known_header::UNKNOWN );
+      TEST_ASSERT( classify( "" ) == http::known_header::UNKNOWN );
+      TEST_ASSERT( std::strcmp( http::known_header_name( http::known_header::UNKNOWN ), "" ) == 0 );
+
+      TEST_ASSERT( value( http::known_header::CONTENT_LENGTH, "123" ) );
+      TEST_ASSERT( ! value( http::known_header::CONTENT_LENGTH, "12a" ) );
+      TEST_ASSERT( value( http::known_header::HOST, "www.example.com:8080" ) );
+      TEST_ASSERT( ! value( http::known_header::HOST, "www.example.com:80x" ) );
+      TEST_ASSERT( value( http::known_header::TE, "trailers, deflate;q=0.5" ) );
+      TEST_ASSERT( value( http::known_header::CONNECTION, "keep-alive, Upgrade" ) );
+      TEST_ASSERT( ! value( http::known_header::CONNECTION, "keep alive" ) );
+      TEST_ASSERT( value( http::known_header::ACCEPT, "text/html, */*" ) );
+      TEST_ASSERT( value( http::known_header::UNKNOWN, "anything goes" ) );
+
+      unsigned n = 0;
+      const std::string te = "gzip, chunked";
+      TEST_ASSERT( http::parse_header_value< count_action >( http::known_header::TRANSFER_ENCODING, te.data(), te.size(), n ) );
+      TEST_ASSERT( n == 2 );
+
+      const std::string cl = std::to_string( unsigned( http::known_header::CONTENT_LENGTH ) );
+      const std::string host = std::to_string( unsigned( http::known_header::HOST ) );
+      TEST_ASSERT( typed( "Content-Length: 12 \r\nHost:example.com:80\r\nX-Foo: a b\r\n\r\n" ) == cl + "=12;" + host + "=example.com:80;0=a b;" );
+      TEST_ASSERT( typed( "X-Foo: a b \t\r\nHost: h \r\n\r\n" ) == "0=a b;" + host + "=h;" );
+      TEST_ASSERT( typed( "Content-Length: 12a\r\n\r\n" ) == "invalid" );
+      TEST_ASSERT( typed( "Host: a b\r\n\r\n" ) == "invalid" );
+      TEST_ASSERT( typed( "Accept: a b\r\n\r\n" ) != "invalid" );
+
+      unsigned k = 0;
+      TEST_ASSERT( ( parse_string< seq< http::typed_header_field, eof >, count_action >( "Transfer-Encoding: gzip, chunked", "test", k ) ) );
+      TEST_ASSERT( k == 2 );
+
+      http::known_header h = http::known_header::UNKNOWN;
+      const std::string f = "Host:";
+      TEST_ASSERT( ( parse_string< field, http::classify_action >( f, "test", h ) ) );
+      TEST_ASSERT( h == http::known_header::HOST );
+   }
+
+} // pegtl
+
+#include "main.hh"
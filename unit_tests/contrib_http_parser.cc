@@ -0,0 +1,197 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "test.hh"
+
+#include <pegtl/contrib/http_parser.hh>
+
+namespace pegtl
+{
+   namespace http_parser_test
+   {
+      std::string decode_chunked( const std::string & data, const std::size_t piece, http::parse_status & status, std::size_t & consumed )
+      {
+         std::string body;
+         http::chunked_decoder d;
+         std::size_t offset = 0;
+         std::size_t end = 0;
+         do {
+            end = std::min( end + piece, data.size() );
+            std::size_t n = 0;
+            status = d.decode( data.data() + offset, end - offset, n, [ & ]( const http::view & v ){ body.append( v.begin(), v.end() ); } );
+            offset += n;
+         } while ( ( status == http::parse_status::INCOMPLETE ) && ( end < data.size() ) );
+         consumed = offset;
+         return body;
+      }
+
+      // The parser must accept exactly the heads that match the grammar, here
+      // for all inputs that differ from a valid head in one byte, and find
+      // all prefixes of the valid head incomplete.
+
+      template< typename Head, typename Message, typename F >
+      void compare( const std::string & valid, const F & f )
+      {
+         static const char bytes[] = { ' ', '\t', '\r', '\n', ':', '/', '%', '0', 'a', '?', '#', '"', '*', '\x7f', '\x80', '\0' };
+         std::vector< std::string > inputs( 1, valid );
+         for ( std::size_t i = 0; i < valid.size(); ++i ) {
+            inputs.push_back( std::string( valid ).erase( i, 1 ) );
+            for ( const char c : bytes ) {
+               inputs.push_back( std::string( valid ).insert( i, 1, c ) );
+               inputs.push_back( std::string( valid ).replace( i, 1, 1, c ) );
+            }
+         }
+         for ( std::size_t i = 0; i < valid.size(); ++i ) {
+            Message m;
+            std::size_t consumed = 0;
+            TEST_ASSERT( f( valid.data(), i, m, consumed ) == http::parse_status::INCOMPLETE );
+         }
+         for ( const auto & in : inputs ) {
+            Message m;
+            std::size_t consumed = 0;
+            const http::parse_status s = f( in.data(), in.size(), m, consumed );
+            bool whole = false;
+            bool head = false;
+            try {
+               whole = parse_string< Head >( in, "compare" );
+               head = ( s == http::parse_status::COMPLETE ) && parse_string< Head >( in.substr( 0, consumed ), "compare" );
+            }
+            catch ( const parse_error & ) {
+            }
+            TEST_ASSERT( whole == ( ( s == http::parse_status::COMPLETE ) && ( consumed == in.size() ) ) );
+            TEST_ASSERT( head == ( s == http::parse_status::COMPLETE ) );
+         }
+      }
+
+      http::parse_status request( const char * data, const std::size_t size, http::request<> & r, std::size_t & consumed )
+      {
+         return http::parse_request( data, size, r, consumed );
+      }
+
+      http::parse_status response( const char * data, const std::size_t size, http::response<> & r, std::size_t & consumed )
+      {
+         return http::parse_response( data, size, r, consumed );
+      }
+
+   } // http_parser_test
+
+   void unit_test()
+   {
+      using namespace http_parser_test;
+
+      {
+         const std::string data = "\r\nGET /index.html?x=1 HTTP/1.1\r\nHost: www.example.com\r\nAccept:  text/html \r\ncontent-length: 5\r\n\r\nhelloPOST / HTTP/1.0\r\n\r\n";
+         http::request<> r;
+         std::size_t consumed = 0;
+         TEST_ASSERT( http::parse_request( data.data(), data.size(), r, consumed ) == http::parse_status::COMPLETE );
+         TEST_ASSERT( r.method.string() == "GET" );
+         TEST_ASSERT( r.target.string() == "/index.html?x=1" );
+         TEST_ASSERT( r.major_version == 1 );
+         TEST_ASSERT( r.minor_version == 1 );
+         TEST_ASSERT( r.header_count == 3 );
+         TEST_ASSERT( r.headers[ 0 ].name.string() == "Host" );
+         TEST_ASSERT( r.headers[ 1 ].value.string() == "text/html" );
+         TEST_ASSERT( r.find( "CONTENT-LENGTH" ) == r.headers + 2 );
+         TEST_ASSERT( r.find( "Content" ) == nullptr );
+         TEST_ASSERT( r.headers[ 0 ].id == http::known_header::HOST );
+         TEST_ASSERT( r.headers[ 2 ].id == http::known_header::CONTENT_LENGTH );
+         TEST_ASSERT( r.find( http::known_header::ACCEPT ) == r.headers + 1 );
+         TEST_ASSERT( r.find( http::known_header::CONNECTION ) == nullptr );
+         TEST_ASSERT( r.target.begin() == data.data() + 6 );
+
+         const std::size_t head = consumed;
+         std::size_t length = 0;
+         TEST_ASSERT( r.body( length ) == http::body_kind::LENGTH );
+         TEST_ASSERT( length == 5 );
+         TEST_ASSERT( data.compare( consumed, length, "hello" ) == 0 );
+
+         // Pipelined request.
+         const std::size_t offset = consumed + length;
+         TEST_ASSERT( http::parse_request( data.data() + offset, data.size() - offset, r, consumed ) == http::parse_status::COMPLETE );
+         TEST_ASSERT( offset + consumed == data.size() );
+         TEST_ASSERT( r.method.string() == "POST" );
+         TEST_ASSERT( r.minor_version == 0 );
+         TEST_ASSERT( r.header_count == 0 );
+         TEST_ASSERT( r.body( length ) == http::body_kind::NONE );
+
+         // Incomplete heads, also when continuing the search.
+         for ( std::size_t i = 0; i < head; ++i ) {
+            TEST_ASSERT( http::parse_request( data.data(), i, r, consumed ) == http::parse_status::INCOMPLETE );
+            TEST_ASSERT( http::parse_request( data.data(), i + 1, r, consumed, i ) == ( ( i + 1 == head ) ? http::parse_status::COMPLETE : http::parse_status::INCOMPLETE ) );
+         }
+      } {
+         const std::string data = "HTTP/1.1 404 Not Found\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n";
+         http::response<> r;
+         std::size_t consumed = 0;
+         std::size_t length = 0;
+         TEST_ASSERT( http::parse_response( data.data(), data.size(), r, consumed ) == http::parse_status::COMPLETE );
+         TEST_ASSERT( consumed == data.size() );
+         TEST_ASSERT( r.status == 404 );
+         TEST_ASSERT( r.reason.string() == "Not Found" );
+         TEST_ASSERT( r.body( length ) == http::body_kind::CHUNKED );
+      } {
+         http::response<> r;
+         std::size_t consumed = 0;
+         std::size_t length = 0;
+         const std::string data = "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nContent-Length: 4\r\n\r\n";
+         TEST_ASSERT( http::parse_response( data.data(), data.size(), r, consumed ) == http::parse_status::COMPLETE );
+         TEST_ASSERT( r.body( length ) == http::body_kind::INVALID );
+         const std::string data2 = "HTTP/1.1 200 OK\r\n\r\n";
+         TEST_ASSERT( http::parse_response( data2.data(), data2.size(), r, consumed ) == http::parse_status::COMPLETE );
+         TEST_ASSERT( r.body( length ) == http::body_kind::CLOSE );
+         const std::string data3 = "HTTP/1.1 304 Not Modified\r\nContent-Length: 10\r\n\r\n";
+         TEST_ASSERT( http::parse_response( data3.data(), data3.size(), r, consumed ) == http::parse_status::COMPLETE );
+         TEST_ASSERT( r.body( length ) == http::body_kind::NONE );
+      } {
+         http::request< 2 > r;
+         std::size_t consumed = 0;
+         const std::string many = "GET / HTTP/1.1\r\nA: 1\r\nB: 2\r\nC: 3\r\n\r\n";
+         TEST_ASSERT( http::parse_request( many.data(), many.size(), r, consumed ) == http::parse_status::INVALID );
+         const std::string bad_version = "GET / HTTX/1.1\r\n\r\n";
+         TEST_ASSERT( http::parse_request( bad_version.data(), bad_version.size(), r, consumed ) == http::parse_status::INVALID );
+         const std::string bad_header = "GET / HTTP/1.1\r\nA B: 1\r\n\r\n";
+         TEST_ASSERT( http::parse_request( bad_header.data(), bad_header.size(), r, consumed ) == http::parse_status::INVALID );
+      } {
+         http::request<> r;
+         std::size_t consumed = 0;
+         const std::string folded = "GET / HTTP/1.1\r\nA: x\r\n \ty \r\nB:\r\n \r\n\r\n";
+         TEST_ASSERT( http::parse_request( folded.data(), folded.size(), r, consumed ) == http::parse_status::COMPLETE );
+         TEST_ASSERT( r.headers[ 0 ].value.string() == "x\r\n \ty" );
+         TEST_ASSERT( r.headers[ 1 ].value.string() == "\r\n " );
+         const std::string space_before_fold = "GET / HTTP/1.1\r\nA: x \r\n y\r\n\r\n";
+         TEST_ASSERT( http::parse_request( space_before_fold.data(), space_before_fold.size(), r, consumed ) == http::parse_status::INVALID );
+
+         compare< http::request_head, http::request<> >( "GET /a%20b/?x=1&y=/z HTTP/1.1\r\nHost: h\r\nX-Y:  v w \r\nZ: a\r\n b\r\n\r\n", request );
+         compare< http::request_head, http::request<> >( "OPTIONS * HTTP/1.0\r\n\r\n", request );
+         compare< http::request_head, http::request<> >( "GET http://a.b/c?d HTTP/1.1\r\n\r\n", request );
+         compare< http::request_head, http::request<> >( "CONNECT a.b:80 HTTP/1.1\r\nA:b\r\n\r\n", request );
+         compare< http::response_head, http::response<> >( "HTTP/1.1 200 O K\r\nA: \r\nB: \x80\r\n\r\n", response );
+      } {
+         const std::string data = "4\r\nWiki\r\n5;ext=\"x\"\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\nExpires: never\r\n\r\nGET";
+         for ( std::size_t piece = 1; piece <= data.size(); ++piece ) {
+            http::parse_status status;
+            std::size_t consumed = 0;
+            TEST_ASSERT( decode_chunked( data, piece, status, consumed ) == "Wikipedia in\r\n\r\nchunks." );
+            TEST_ASSERT( status == http::parse_status::COMPLETE );
+            TEST_ASSERT( consumed == data.size() - 3 );
+         }
+         http::parse_status status;
+         std::size_t consumed = 0;
+         decode_chunked( "4\r\nWikiX\r\n", 100, status, consumed );
+         TEST_ASSERT( status == http::parse_status::INVALID );
+         decode_chunked( "x\r\n", 100, status, consumed );
+         TEST_ASSERT( status == http::parse_status::INVALID );
+         decode_chunked( "fffffffffffffffffffffff\r\n", 100, status, consumed );
+         TEST_ASSERT( status == http::parse_status::INVALID );
+         decode_chunked( "3\r\nabc\r\n", 100, status, consumed );
+         TEST_ASSERT( status == http::parse_status::INCOMPLETE );
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,148 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <sstream>
+
+#include "test.hh"
+
+#include <pegtl/contrib/instrument.hh>
+
+namespace pegtl
+{
+   namespace instrument_test
+   {
+      struct a : one< 'a' > {};
+      struct b : one< 'b' > {};
+      struct grammar : seq< plus< a >, must< b > > {};
+
+      // A base control class with its own error message.
+
+      template< typename Rule >
+      struct base
+            : normal< Rule >
+      {
+         template< typename Input, typename ... States >
+         static void raise( const Input & in, States && ... )
+         {
+            throw parse_error( "custom", in );
+         }
+      };
+
+      template< typename Rule > using control = instrumented< base >::control< Rule >;
+
+      // A recursive rule whose action throws for the innermost match, i.e.
+      // after the rule itself succeeded, which is caught by the enclosing one.
+
+      struct rec : seq< one< '(' >, opt< try_catch< rec > >, star< not_one< ')' > >, one< ')' > > {};
+      struct nested : seq< rec, one< ')' >, eof > {};
+
+      template< typename Rule > struct rec_action : nothing< Rule > {};
+
+      template<> struct rec_action< rec >
+      {
+         template< typename Input >
+         static void apply( const Input & in )
+         {
+            if ( in.string() == "(!)" ) {
+               throw parse_error( "innermost", in );
+            }
+         }
+      };
+
+      std::string message( const std::string & in )
+      {
+         try {
+            parse_string< grammar, nothing, control >( in, __FILE__ );
+         }
+         catch ( const parse_error & e ) {
+            return e.what();
+         }
+         return "";
+      }
+
+   } // instrument_test
+
+   void unit_test()
+   {
+      const auto id_a = internal::rule_id< instrument_test::a >::value;
+      const auto id_b = internal::rule_id< instrument_test::b >::value;
+
+      TEST_ASSERT( instrument_test::message( "aa" ).find( "custom" ) != std::string::npos );
+
+      instrument::coverage_sink c;
+      instrument::registry::add( c );
+      TEST_ASSERT( ! instrument::registry::active() );
+      TEST_ASSERT( ( parse_string< instrument_test::grammar, nothing, instrumented<>::control >( "aab", __FILE__ ) ) );
+      TEST_ASSERT( c.entries().empty() );
+
+      instrument::registry::enable();
+      TEST_ASSERT( instrument::registry::active() );
+      TEST_ASSERT( ( parse_string< instrument_test::grammar, nothing, instrumented<>::control >( "aab", __FILE__ ) ) );
+      TEST_ASSERT( c.entries()[ id_a ].start == 3 );
+      TEST_ASSERT( c.entries()[ id_a ].success == 2 );
+      TEST_ASSERT( c.entries()[ id_a ].failure == 1 );
+      TEST_ASSERT( c.entries()[ id_b ].success == 1 );
+
+      std::ostringstream o;
+      instrument::ostream_sink s( o );
+      instrument::registry::add( s );
+      try {
+         parse_string< instrument_test::grammar, nothing, instrumented<>::control >( "aa", __FILE__ );
+         TEST_ASSERT( false );
+      }
+      catch ( const parse_error & ) {
+      }
+      TEST_ASSERT( c.entries()[ id_b ].raise == 1 );
+      TEST_ASSERT( o.str().find( "1:0  start pegtl::instrument_test::grammar\n" ) == 0 );
+      TEST_ASSERT( o.str().find( "1:2 failure pegtl::instrument_test::b\n" ) != std::string::npos );
+
+      TEST_ASSERT( instrument_test::message( "aa" ).find( "custom" ) != std::string::npos );
+      TEST_ASSERT( c.entries()[ id_b ].raise == 2 );
+
+      instrument::registry::remove( c );
+      instrument::registry::remove( s );
+
+      instrument::profile_sink p;
+      instrument::registry::add( p );
+      TEST_ASSERT( ( parse_string< instrument_test::grammar, nothing, instrumented<>::control >( "aaab", __FILE__ ) ) );
+      TEST_ASSERT( p.entry( id_a ).start == 4 );
+      TEST_ASSERT( p.entry( id_a ).success == 3 );
+      TEST_ASSERT( p.entry( id_a ).failure == 1 );
+      TEST_ASSERT( p.entry( id_a ).bytes == 3 );
+      TEST_ASSERT( p.entry( internal::rule_id< instrument_test::grammar >::value ).bytes == 4 );
+
+      // Two sinks keep separate frames and tables.
+
+      const auto id_rec = internal::rule_id< instrument_test::rec >::value;
+      instrument::profile_sink t( true );
+      instrument::registry::add( t );
+      p.reset();
+      TEST_ASSERT( ( parse_string< instrument_test::nested, instrument_test::rec_action, instrumented<>::control >( "((!))", __FILE__ ) ) );
+      for ( const auto * q : { & p, & t } ) {
+         TEST_ASSERT( q->entries()[ id_rec ].start == 3 );
+         TEST_ASSERT( q->entries()[ id_rec ].success == 1 );
+         TEST_ASSERT( q->entries()[ id_rec ].failure == 1 );
+         TEST_ASSERT( q->entries()[ id_rec ].bytes == 4 );
+         TEST_ASSERT( q->entries()[ internal::rule_id< instrument_test::nested >::value ].bytes == 5 );
+      }
+      std::ostringstream r;
+      t.report( r );
+      TEST_ASSERT( r.str().find( "pegtl::instrument_test::rec\n" ) != std::string::npos );
+      instrument::registry::remove( t );
+      instrument::registry::remove( p );
+      instrument::registry::add( s );
+
+      instrument::registry::enable( false );
+      TEST_ASSERT( ! instrument::registry::active() );
+      instrument::registry::enable();
+      TEST_ASSERT( instrument::registry::active() );
+      instrument::registry::remove( s );
+      TEST_ASSERT( ! instrument::registry::active() );
+      TEST_ASSERT( instrument::registry::all().empty() );
+      instrument::registry::enable( false );
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,119 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <vector>
+
+#include "test.hh"
+
+#include <pegtl/contrib/json_parallel.hh>
+
+namespace pegtl
+{
+   namespace json_parallel_test
+   {
+      struct numbers
+      {
+         std::vector< std::string > values;
+      };
+
+      template< typename Rule > struct numbers_action : nothing< Rule > {};
+
+      template<> struct numbers_action< json::number >
+      {
+         template< typename Input >
+         static void apply( const Input & in, numbers & n )
+         {
+            n.values.push_back( in.string() );
+         }
+      };
+
+      void reduce( numbers & r, numbers && n )
+      {
+         r.values.insert( r.values.end(), n.values.begin(), n.values.end() );
+      }
+
+      std::vector< std::string > parse( const std::string & data, const std::size_t threads, const std::size_t chunk_size )
+      {
+         numbers n;
+         const memory_input in( 1, 0, data.data(), data.data() + data.size(), __FILE__ );
+         TEST_ASSERT( json::parse_array_parallel< numbers_action >( in, n, reduce, threads, chunk_size ) );
+         return n.values;
+      }
+
+      void verify_index( const std::string & data, const std::size_t size, const bool result, const std::size_t chunks )
+      {
+         std::vector< internal::json_chunk > c;
+         TEST_ASSERT( internal::json_array_index( data.data(), data.data() + data.size(), 1, 0, size, c ) == result );
+         if ( result ) {
+            TEST_ASSERT( c.size() == chunks );
+         }
+      }
+
+   } // json_parallel_test
+
+   void unit_test()
+   {
+      json_parallel_test::verify_index( "[]", 1, true, 1 );
+      json_parallel_test::verify_index( " [ 1 , 2 ] \n", 1, true, 2 );
+      json_parallel_test::verify_index( "[1,[2,3],{\"a\":4},5]", 1, true, 4 );
+      json_parallel_test::verify_index( "[\",\\\",[\",2]", 1, true, 2 );
+      json_parallel_test::verify_index( "[\"abcdefghijklmnop,qrstuvwxyz\\\\\",\"x\"]", 1, true, 2 );
+      json_parallel_test::verify_index( "[1,2,3,4]", 100, true, 1 );
+      json_parallel_test::verify_index( "{}", 1, false, 0 );
+      json_parallel_test::verify_index( "[1,2", 1, false, 0 );
+      json_parallel_test::verify_index( "[1,2}", 1, false, 0 );
+      json_parallel_test::verify_index( "[1,2] 3", 1, false, 0 );
+      json_parallel_test::verify_index( "[\"]", 1, false, 0 );
+
+      std::string data = "[";
+      std::vector< std::string > expected;
+      for ( unsigned i = 0; i < 3000; ++i ) {
+         data += ( i ? ",\n  " : "\n  " );
+         if ( i % 3 == 0 ) {
+            data += "{ \"key\": [ " + std::to_string( i ) + ", \"],[{\\\"\" ] }";
+         }
+         else {
+            data += std::to_string( i );
+         }
+         expected.push_back( std::to_string( i ) );
+      }
+      data += "\n]\n";
+
+      for ( std::size_t threads = 1; threads < 4; ++threads ) {
+         for ( std::size_t chunk : { 1, 50, 1000, 1 << 20 } ) {
+            TEST_ASSERT( json_parallel_test::parse( data, threads, chunk ) == expected );
+         }
+      }
+      TEST_ASSERT( json_parallel_test::parse( " [ ] ", 2, 1 ).empty() );
+      TEST_ASSERT( ( json_parallel_test::parse( "{ \"a\": [ 1, 2 ] }", 2, 1 ) == std::vector< std::string >{ "1", "2" } ) );
+
+      const std::size_t line = 2002;
+      const auto b = data.find( "  2000" ) + 2;
+      for ( const auto & error : { std::string( "x" ), std::string( "1," ), std::string( "[" ) } ) {
+         std::string bad = data;
+         bad.replace( b, 4, error );
+         for ( std::size_t chunk : { 1, 100, 1 << 20 } ) {
+            try {
+               json_parallel_test::parse( bad, 2, chunk );
+               TEST_ASSERT( false );
+            }
+            catch ( const parse_error & e ) {
+               TEST_ASSERT( e.positions.size() == 1 );
+               TEST_ASSERT( e.positions[ 0 ].line == line );
+            }
+         }
+      }
+      try {
+         json_parallel_test::parse( "[1,]", 2, 1 );
+         TEST_ASSERT( false );
+      }
+      catch ( const parse_error & e ) {
+         TEST_ASSERT( e.positions.size() == 1 );
+         TEST_ASSERT( e.positions[ 0 ].byte_in_line == 3 );
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
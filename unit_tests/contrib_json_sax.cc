@@ -0,0 +1,63 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include "test.hh"
+
+#include <pegtl/contrib/json_sax.hh>
+
+namespace pegtl
+{
+   struct test_consumer
+         : json::sax_base
+   {
+      std::string events;
+      const char * last = nullptr;
+
+      void null() { events += 'n'; }
+      void boolean( const bool b ) { events += b ? 't' : 'f'; }
+      void number( const char * b, const std::size_t s ) { events += '#' + std::string( b, s ); }
+      void string( const char * b, const std::size_t s ) { events += '"' + std::string( b, s ) + '"'; last = b; }
+      void key( const char * b, const std::size_t s ) { events += std::string( b, s ) + ':'; }
+      void begin_array() { events += '['; }
+      void end_array() { events += ']'; }
+      void begin_object() { events += '{'; }
+      void end_object() { events += '}'; }
+   };
+
+   void verify_events( const std::size_t line, const char * file, const std::string & data, const std::string & events )
+   {
+      test_consumer c;
+      json::sax_state< test_consumer > st( c );
+      if ( ! parse_string< must< json::text, eof >, json::sax_action >( data, file, st ) ) {
+         std::cerr << "pegtl: unit test failed for [ " << data << " ] in line [ " << line << " ] file [ " << file << " ]" << std::endl;
+         ++failed;
+      }
+      else if ( c.events != events ) {
+         std::cerr << "pegtl: unit test failed for [ " << data << " ] got [ " << c.events << " ] expected [ " << events << " ] in line [ " << line << " ] file [ " << file << " ]" << std::endl;
+         ++failed;
+      }
+   }
+
+   void unit_test()
+   {
+      verify_events( __LINE__, __FILE__, "null", "n" );
+      verify_events( __LINE__, __FILE__, " [ true , false ] ", "[tf]" );
+      verify_events( __LINE__, __FILE__, "[-1.5e3,0]", "[#-1.5e3#0]" );
+      verify_events( __LINE__, __FILE__, "{\"a\":{},\"b\":[[]]}", "{a:{}b:[[]]}" );
+      verify_events( __LINE__, __FILE__, "[\"\",\"abc\"]", "[\"\"\"abc\"]" );
+      verify_events( __LINE__, __FILE__, "[\"a\\tb\\n\\\\\\\"\\/\"]", "[\"a\tb\n\\\"/\"]" );
+      verify_events( __LINE__, __FILE__, "[\"\\u0041\\u00e4\\u20ac\"]", "[\"A\xc3\xa4\xe2\x82\xac\"]" );
+      verify_events( __LINE__, __FILE__, "[\"\\uD834\\uDD1E\"]", "[\"\xf0\x9d\x84\x9e\"]" );
+      verify_events( __LINE__, __FILE__, "[\"\\uD834x\"]", "[\"\xed\xa0\xb4x\"]" );
+      verify_events( __LINE__, __FILE__, "{\"k\\u0041\":null}", "{kA:n}" );
+
+      const std::string data = "[\"view\"]";
+      test_consumer c;
+      json::sax_state< test_consumer > st( c );
+      parse_string< json::text, json::sax_action >( data, __FUNCTION__, st );
+      TEST_ASSERT( c.last == data.data() + 2 );
+   }
+
+} // pegtl
+
+#include "main.hh"
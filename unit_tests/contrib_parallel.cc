@@ -0,0 +1,149 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "test.hh"
+
+#include <pegtl/contrib/json.hh>
+#include <pegtl/contrib/parallel.hh>
+
+namespace pegtl
+{
+   namespace parallel_test
+   {
+      struct record : seq< plus< digit >, eol > {};
+      struct grammar : must< star< record >, eof > {};
+      struct nonempty : must< plus< record >, eof > {};
+
+      struct sum
+      {
+         std::size_t records = 0;
+         unsigned long total = 0;
+      };
+
+      template< typename Rule > struct sum_action : nothing< Rule > {};
+
+      template<> struct sum_action< plus< digit > >
+      {
+         template< typename Input >
+         static void apply( const Input & in, sum & s )
+         {
+            ++s.records;
+            s.total += std::stoul( in.string() );
+         }
+      };
+
+      void reduce( sum & r, sum && s )
+      {
+         r.records += s.records;
+         r.total += s.total;
+      }
+
+      struct texts
+      {
+         std::size_t count = 0;
+      };
+
+      template< typename Rule > struct texts_action : nothing< Rule > {};
+
+      template<> struct texts_action< json::text >
+      {
+         template< typename Input >
+         static void apply( const Input &, texts & t )
+         {
+            ++t.count;
+         }
+      };
+
+      void test_files()
+      {
+         const std::vector< std::string > paths = { "unit_tests/data/pass1.json", "unit_tests/data/fail2.json", "unit_tests/data/missing.json", "unit_tests/data/pass2.json", "unit_tests/data/pass3.json" };
+
+         for ( std::size_t threads = 1; threads < 4; ++threads ) {
+            std::size_t states = 0;
+            std::size_t count = 0;
+            const auto results = parse_files< must< json::text, eof >, texts_action >( paths, [ & ](){ ++states; return texts(); }, [ & ]( texts && t ){ count += t.count; }, threads );
+            TEST_ASSERT( results.size() == paths.size() );
+            TEST_ASSERT( states == threads );
+            TEST_ASSERT( count == 3 );
+            for ( std::size_t i = 0; i < paths.size(); ++i ) {
+               TEST_ASSERT( results[ i ].success == ( ( i != 1 ) && ( i != 2 ) ) );
+               TEST_ASSERT( bool( results[ i ].error ) == ( ( i == 1 ) || ( i == 2 ) ) );
+            }
+            try {
+               std::rethrow_exception( results[ 1 ].error );
+            }
+            catch ( const parse_error & e ) {
+               TEST_ASSERT( e.positions.size() == 1 );
+               TEST_ASSERT( e.positions[ 0 ].source == paths[ 1 ] );
+            }
+            try {
+               std::rethrow_exception( results[ 2 ].error );
+            }
+            catch ( const input_error & ) {
+            }
+         }
+      }
+
+   } // parallel_test
+
+   void unit_test()
+   {
+      {
+         const char * const text = "a\nbb\nccc\n";
+         const auto chunks = internal::split_lines( text, text + 9, 2 );
+         TEST_ASSERT( chunks.size() == 3 );
+         TEST_ASSERT( chunks[ 1 ] == text + 5 );
+         TEST_ASSERT( chunks[ 2 ] == text + 9 );
+         TEST_ASSERT( internal::split_lines( text, text, 2 ).size() == 2 );
+      }
+      std::string data;
+      unsigned long total = 0;
+      for ( unsigned i = 0; i < 10000; ++i ) {
+         data += std::to_string( i ) + '\n';
+         total += i;
+      }
+      for ( std::size_t threads = 1; threads < 5; ++threads ) {
+         for ( std::size_t chunk : { 1, 100, 4096, 1 << 20 } ) {
+            parallel_test::sum s;
+            const memory_input in( 1, 0, data.data(), data.data() + data.size(), __FILE__ );
+            TEST_ASSERT( ( parse_lines_parallel< parallel_test::grammar, parallel_test::sum_action >( in, s, parallel_test::reduce, threads, chunk ) ) );
+            TEST_ASSERT( s.records == 10000 );
+            TEST_ASSERT( s.total == total );
+         }
+      }
+      {
+         parallel_test::sum s;
+         const memory_input in( 1, 0, data.data(), data.data(), __FILE__ );
+         TEST_ASSERT( ( parse_lines_parallel< parallel_test::grammar, parallel_test::sum_action >( in, s, parallel_test::reduce ) ) );
+         TEST_ASSERT( s.records == 0 );
+         try {
+            parse_lines_parallel< parallel_test::nonempty, parallel_test::sum_action >( in, s, parallel_test::reduce );
+            TEST_ASSERT( false );
+         }
+         catch ( const parse_error & ) {
+         }
+      }
+      data[ data.size() - 300 ] = 'x';
+      const std::size_t line = std::count( data.data(), data.data() + data.size() - 300, '\n' ) + 1;
+      for ( std::size_t threads = 1; threads < 4; ++threads ) {
+         parallel_test::sum s;
+         const memory_input in( 1, 0, data.data(), data.data() + data.size(), __FILE__ );
+         try {
+            parse_lines_parallel< parallel_test::grammar, parallel_test::sum_action >( in, s, parallel_test::reduce, threads, 1000 );
+            TEST_ASSERT( false );
+         }
+         catch ( const parse_error & e ) {
+            TEST_ASSERT( e.positions.size() == 1 );
+            TEST_ASSERT( e.positions[ 0 ].line == line );
+         }
+      }
+      parallel_test::test_files();
+   }
+
+} // pegtl
+
+#include "main.hh"
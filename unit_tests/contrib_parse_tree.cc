@@ -0,0 +1,103 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include "test.hh"
+
+#include <pegtl/contrib/parse_tree.hh>
+
+namespace pegtl
+{
+   struct number : plus< digit > {};
+   struct name : plus< alpha > {};
+   struct item : sor< seq< name, one< '=' >, number >, number > {};
+   struct grammar : seq< list< item, one< ',' > >, eof > {};
+
+   template< typename Rule > struct selector : std::false_type {};
+   template<> struct selector< number > : std::true_type {};
+   template<> struct selector< name > : std::true_type {};
+   template<> struct selector< item > : std::true_type {};
+
+   // Alternatives that fail after some of their nodes were built.
+
+   struct item2 : sor< seq< name, one< '=' >, number >, name > {};
+   struct backtrack : seq< at< name >, sor< seq< item2, one< ';' > >, item2 >, eof > {};
+
+   template< typename Rule > struct selector2 : std::false_type {};
+   template<> struct selector2< number > : std::true_type {};
+   template<> struct selector2< name > : std::true_type {};
+   template<> struct selector2< item2 > : std::true_type {};
+
+   // Rules aborted by an exception that is caught within the grammar.
+
+   struct a : one< 'a' > {};
+   struct b : one< 'b' > {};
+   struct caught : seq< opt< try_catch< seq< a, must< b > > > >, star< a >, eof > {};
+
+   void unit_test()
+   {
+      parse_tree::tree t;
+      const std::string data = "12,ab=3";
+      TEST_ASSERT( ( parse_tree::parse_string< grammar, selector >( data, __FUNCTION__, t ) ) );
+
+      const auto & r = t.root();
+      TEST_ASSERT( r.is< void >() );
+      TEST_ASSERT( r.begin == 0 );
+      TEST_ASSERT( r.end == data.size() );
+      TEST_ASSERT( r.count == 2 );
+      TEST_ASSERT( t.nodes().size() == 6 );
+
+      const auto * i = t.begin( r );
+      TEST_ASSERT( i[ 0 ].is< item >() );
+      TEST_ASSERT( t.string( i[ 0 ] ) == "12" );
+      TEST_ASSERT( i[ 0 ].count == 1 );
+      TEST_ASSERT( t.begin( i[ 0 ] )->is< number >() );
+      TEST_ASSERT( t.begin( i[ 0 ] )->count == 0 );
+
+      TEST_ASSERT( i[ 1 ].is< item >() );
+      TEST_ASSERT( t.string( i[ 1 ] ) == "ab=3" );
+      TEST_ASSERT( i[ 1 ].count == 2 );
+      TEST_ASSERT( t.end( i[ 1 ] ) - t.begin( i[ 1 ] ) == 2 );
+      TEST_ASSERT( t.begin( i[ 1 ] )[ 0 ].is< name >() );
+      TEST_ASSERT( t.string( t.begin( i[ 1 ] )[ 0 ] ) == "ab" );
+      TEST_ASSERT( t.begin( i[ 1 ] )[ 1 ].is< number >() );
+      TEST_ASSERT( t.string( t.begin( i[ 1 ] )[ 1 ] ) == "3" );
+      TEST_ASSERT( t.begin( i[ 1 ] )[ 1 ].name() == internal::demangle< number >() );
+
+      TEST_ASSERT( ! ( parse_tree::parse_string< grammar, selector >( "12,", __FUNCTION__, t ) ) );
+
+      const std::string alternatives = "ab";
+      TEST_ASSERT( ( parse_tree::parse_string< backtrack, selector2 >( alternatives, __FUNCTION__, t ) ) );
+      TEST_ASSERT( t.nodes().size() == 3 );
+      TEST_ASSERT( t.root().count == 1 );
+      TEST_ASSERT( t.begin( t.root() )->is< item2 >() );
+      TEST_ASSERT( t.begin( t.root() )->count == 1 );
+      TEST_ASSERT( t.begin( * t.begin( t.root() ) )->is< name >() );
+      TEST_ASSERT( t.string( * t.begin( * t.begin( t.root() ) ) ) == "ab" );
+
+      const std::string aa = "aa";
+      TEST_ASSERT( ( parse_tree::parse_string< caught >( aa, __FUNCTION__, t ) ) );
+      TEST_ASSERT( t.root().count == 1 );
+      const auto & c = * t.begin( t.root() );
+      TEST_ASSERT( c.is< caught >() );
+      TEST_ASSERT( c.count == 3 );
+      const auto * k = t.begin( c );
+      TEST_ASSERT(( k[ 0 ].is< opt< try_catch< seq< a, must< b > > > > >() ));
+      TEST_ASSERT( k[ 0 ].count == 0 );
+      TEST_ASSERT( k[ 0 ].end == 0 );
+      TEST_ASSERT( k[ 1 ].is< star< a > >() );
+      TEST_ASSERT( k[ 1 ].count == 2 );
+      TEST_ASSERT( t.begin( k[ 1 ] )[ 0 ].is< a >() );
+      TEST_ASSERT( t.begin( k[ 1 ] )[ 0 ].begin == 0 );
+      TEST_ASSERT( t.begin( k[ 1 ] )[ 1 ].begin == 1 );
+      TEST_ASSERT( k[ 2 ].is< eof >() );
+      TEST_ASSERT( t.nodes().size() == 7 );
+
+      const std::string other = "1";
+      TEST_ASSERT( ( parse_tree::parse_string< grammar >( other, __FUNCTION__, t ) ) );
+      TEST_ASSERT( t.root().count == 1 );
+      TEST_ASSERT( t.begin( t.root() )->is< grammar >() );
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,148 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <stdexcept>
+
+#include "test.hh"
+
+#include <pegtl/contrib/pipeline.hh>
+
+namespace pegtl
+{
+   namespace pipeline_test
+   {
+      // Reader that returns the lines "0\n" to "N\n" in pieces of at most three bytes.
+
+      struct counting_reader
+      {
+         explicit
+         counting_reader( const unsigned in_count, const bool in_fail = false )
+               : count( in_count ),
+                 fail( in_fail )
+         { }
+
+         std::size_t operator() ( char * buffer, const std::size_t length )
+         {
+            if ( pending.empty() ) {
+               if ( next == count ) {
+                  if ( fail ) {
+                     throw std::runtime_error( "reader failure" );
+                  }
+                  return 0;
+               }
+               pending = std::to_string( next++ ) + '\n';
+            }
+            const std::size_t r = std::min( std::min( length, pending.size() ), std::size_t( 3 ) );
+            pending.copy( buffer, r );
+            pending.erase( 0, r );
+            return r;
+         }
+
+         unsigned count;
+         unsigned next = 0;
+         bool fail;
+         std::string pending;
+      };
+
+      // Transformation that replaces every digit '0' with "zero", with a
+      // trailing "end\n" line when flushed.
+
+      struct zero_transform
+      {
+         void operator() ( const char * data, const std::size_t size, std::string & output )
+         {
+            if ( ! size ) {
+               output += "end\n";
+            }
+            for ( std::size_t i = 0; i < size; ++i ) {
+               if ( data[ i ] == '0' ) {
+                  output += "zero";
+               }
+               else {
+                  output += data[ i ];
+               }
+            }
+         }
+      };
+
+      struct line : seq< plus< sor< digit, pegtl_string_t( "zero" ) > >, eol, discard > {};
+      struct grammar : seq< star< line >, opt< pegtl_string_t( "end" ), eol >, eof > {};
+
+      template< typename Rule > struct count_action : nothing< Rule > {};
+
+      template<> struct count_action< line >
+      {
+         template< typename Input >
+         static void apply( const Input &, std::size_t & count )
+         {
+            ++count;
+         }
+      };
+
+   } // pipeline_test
+
+   void unit_test()
+   {
+      {
+         // A queue that never runs empty keeps cycling through its slots.
+         internal::chunk_queue q( 2 );
+         std::string c;
+         TEST_ASSERT( q.push( "0" ) );
+         for ( unsigned i = 1; i < 100; ++i ) {
+            TEST_ASSERT( q.push( std::to_string( i ) ) );
+            TEST_ASSERT( q.pop( c ) );
+            TEST_ASSERT( c == std::to_string( i - 1 ) );
+         }
+         q.finish();
+         TEST_ASSERT( q.pop( c ) );
+         TEST_ASSERT( c == "99" );
+         TEST_ASSERT( ! q.pop( c ) );
+      }
+      for ( std::size_t chunk : { 1, 7, 1 << 16 } ) {
+         for ( std::size_t queue : { 1, 4 } ) {
+            std::size_t count = 0;
+            buffer_input< pipeline_reader< pipeline_test::counting_reader > > in( "pipeline", 64, pipeline_test::counting_reader( 1000 ), pipeline_identity(), chunk, queue );
+            TEST_ASSERT( ( parse_input< pipeline_test::grammar, pipeline_test::count_action >( in, count ) ) );
+            TEST_ASSERT( count == 1000 );
+            TEST_ASSERT( in.line() == 1001 );
+         }
+      }
+      {
+         std::size_t count = 0;
+         buffer_input< pipeline_reader< pipeline_test::counting_reader, pipeline_test::zero_transform > > in( "pipeline", 64, pipeline_test::counting_reader( 1000 ), pipeline_test::zero_transform(), 5, 2 );
+         TEST_ASSERT( ( parse_input< pipeline_test::grammar, pipeline_test::count_action >( in, count ) ) );
+         TEST_ASSERT( count == 1000 );
+         TEST_ASSERT( in.line() == 1002 );
+      }
+      for ( bool transform : { false, true } ) {
+         std::size_t count = 0;
+         try {
+            if ( transform ) {
+               buffer_input< pipeline_reader< pipeline_test::counting_reader, pipeline_test::zero_transform > > in( "pipeline", 64, pipeline_test::counting_reader( 100, true ), pipeline_test::zero_transform(), 5, 2 );
+               parse_input< pipeline_test::grammar, pipeline_test::count_action >( in, count );
+            }
+            else {
+               buffer_input< pipeline_reader< pipeline_test::counting_reader > > in( "pipeline", 64, pipeline_test::counting_reader( 100, true ), pipeline_identity(), 5, 2 );
+               parse_input< pipeline_test::grammar, pipeline_test::count_action >( in, count );
+            }
+            TEST_ASSERT( false );
+         }
+         catch ( const std::runtime_error & e ) {
+            TEST_ASSERT( std::string( e.what() ) == "reader failure" );
+            // The error is raised while eol looks ahead for a "\r\n" in the last line.
+            TEST_ASSERT( count == 99 );
+         }
+      }
+      {
+         // The parser stops early, the reader and transformation threads must still terminate.
+         std::size_t count = 0;
+         buffer_input< pipeline_reader< pipeline_test::counting_reader, pipeline_test::zero_transform > > in( "pipeline", 64, pipeline_test::counting_reader( unsigned( -1 ) ), pipeline_test::zero_transform(), 5, 2 );
+         TEST_ASSERT( ( parse_input< rep< 10, pipeline_test::line >, pipeline_test::count_action >( in, count ) ) );
+         TEST_ASSERT( count == 10 );
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,130 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include "test.hh"
+
+#include <pegtl/contrib/pooled_state.hh>
+
+namespace pegtl
+{
+   std::size_t constructed = 0;
+
+   struct line_state
+   {
+      std::vector< std::string > words;
+
+      void reset()
+      {
+         words.clear();
+      }
+
+      template< typename Input >
+      void success( const Input &, std::vector< std::string > & lines, state_pool & ) const
+      {
+         std::string s;
+         for ( const auto & w : words ) {
+            s += '<' + w + '>';
+         }
+         lines.push_back( s );
+      }
+   };
+
+   struct word_state
+   {
+      word_state()
+      {
+         ++constructed;
+      }
+
+      std::string word;
+
+      void reset()
+      {
+         word.clear();
+      }
+
+      template< typename Input >
+      void success( const Input &, std::vector< std::string > & words, state_pool & ) const
+      {
+         words.push_back( word );
+      }
+
+      template< typename Input >
+      void success( const Input &, line_state & l ) const
+      {
+         l.words.push_back( word );
+      }
+
+      void success( std::vector< std::string > & words, state_pool & ) const
+      {
+         words.push_back( word );
+      }
+   };
+
+   struct word : plus< alpha > {};
+   struct pooled_word : pooled_state< word_state, word > {};
+   struct grammar : list< sor< pooled_word, digit >, one< ' ' > > {};
+
+   struct changed_word : seq< word > {};
+   struct changed_grammar : list< sor< changed_word, digit >, one< ' ' > > {};
+
+   struct line : pooled_state< line_state, one< '[' >, list< pooled_word, one< ' ' > >, one< ']' > > {};
+   struct lines : list< line, one< ' ' > > {};
+
+   template< typename Rule > struct pool_action : nothing< Rule > {};
+
+   template<>
+   struct pool_action< word >
+   {
+      template< typename Input >
+      static void apply( const Input & in, word_state & s )
+      {
+         TEST_ASSERT( s.word.empty() );
+         s.word = in.string();
+      }
+   };
+
+   template< typename Rule > struct pool_control : normal< Rule > {};
+   template<> struct pool_control< changed_word > : change_pooled_state< changed_word, word_state > {};
+
+   void unit_test()
+   {
+      std::vector< std::string > words;
+      {
+         state_pool pool;
+         parse_string< grammar, pool_action >( "foo 1 bar 2 baz", __FUNCTION__, words, pool );
+         TEST_ASSERT( words.size() == 3 );
+         TEST_ASSERT( words[ 0 ] == "foo" );
+         TEST_ASSERT( words[ 2 ] == "baz" );
+         TEST_ASSERT( constructed == 1 );
+         TEST_ASSERT( pool.size< word_state >() == 1 );
+         TEST_ASSERT( pool.size< line_state >() == 0 );
+
+         words.clear();
+         parse_string< changed_grammar, pool_action, pool_control >( "foo 1 bar 2 baz", __FUNCTION__, words, pool );
+         TEST_ASSERT( words.size() == 3 );
+         TEST_ASSERT( words[ 1 ] == "bar" );
+         TEST_ASSERT( constructed == 1 );
+
+         parse_string< grammar >( "foo 1 bar", __FUNCTION__, words, pool );
+         TEST_ASSERT( constructed == 1 );
+      }
+      {
+         state_pool pool;
+         parse_string< grammar >( "foo", __FUNCTION__, words, pool );
+         TEST_ASSERT( constructed == 2 );
+
+         std::vector< std::string > result;
+         TEST_ASSERT(( parse_string< lines, pool_action >( "[a b] [c] [d e f]", __FUNCTION__, result, pool ) ));
+         TEST_ASSERT( result.size() == 3 );
+         TEST_ASSERT( result[ 0 ] == "<a><b>" );
+         TEST_ASSERT( result[ 2 ] == "<d><e><f>" );
+         TEST_ASSERT( constructed == 2 );
+         TEST_ASSERT( pool.size< word_state >() == 1 );
+         TEST_ASSERT( pool.size< line_state >() == 1 );
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,86 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <thread>
+#include <sstream>
+
+#include "test.hh"
+
+#include <pegtl/contrib/profiler.hh>
+
+namespace pegtl
+{
+   namespace profiler_test
+   {
+      struct a : one< 'a' > {};
+      struct b : one< 'b' > {};
+      struct ab : sor< a, b > {};
+      struct grammar : seq< star< ab >, eof > {};
+
+   } // profiler_test
+
+   void unit_test()
+   {
+      TEST_ASSERT( internal::rule_id< profiler_test::a >::value != internal::rule_id< profiler_test::b >::value );
+      TEST_ASSERT( internal::rule_registry::name( internal::rule_id< profiler_test::a >::value ) == "pegtl::profiler_test::a" );
+
+      TEST_ASSERT( ( parse_string< profiler_test::grammar, nothing, profiler >( "abba", __FILE__ ) ) );
+      {
+         const auto & a = profile::entries()[ internal::rule_id< profiler_test::a >::value ];
+         TEST_ASSERT( a.start == 4 );
+         TEST_ASSERT( a.success == 2 );
+         TEST_ASSERT( a.failure == 2 );
+         TEST_ASSERT( a.bytes == 2 );
+         const auto & ab = profile::entries()[ internal::rule_id< profiler_test::ab >::value ];
+         TEST_ASSERT( ab.start == 4 );
+         TEST_ASSERT( ab.success == 4 );
+         TEST_ASSERT( ab.bytes == 4 );
+         TEST_ASSERT( ab.nanoseconds == 0 );
+      }
+      profile::reset();
+      TEST_ASSERT( profile::entries()[ internal::rule_id< profiler_test::a >::value ].start == 0 );
+
+      TEST_ASSERT( ( parse_string< profiler_test::grammar, nothing, timed_profiler >( "ab", __FILE__ ) ) );
+      {
+         const auto & g = profile::entries()[ internal::rule_id< profiler_test::grammar >::value ];
+         TEST_ASSERT( g.start == 1 );
+         TEST_ASSERT( g.success == 1 );
+         TEST_ASSERT( g.bytes == 2 );
+      }
+      std::ostringstream o;
+      profile::report( o );
+      const auto r = o.str();
+      TEST_ASSERT( r.find( "pegtl::profiler_test::grammar" ) < r.find( "pegtl::profiler_test::ab" ) );
+      TEST_ASSERT( r.find( "pegtl::profiler_test::ab" ) < r.find( "pegtl::profiler_test::a\n" ) );
+      TEST_ASSERT( r.find( "buffer:" ) == std::string::npos );
+
+      TEST_ASSERT( profile::buffer().reader_calls == 0 );
+      TEST_ASSERT( ( parse_cstring< profiler_test::grammar, nothing, profiler >( "abba", __FILE__, 16 ) ) );
+      TEST_ASSERT( profile::buffer().reader_calls == 0 );
+      const auto starts = profile::entries()[ internal::rule_id< profiler_test::a >::value ].start;
+      buffer_input< internal::cstring_reader > in( __FILE__, 16, "abba" );
+      TEST_ASSERT( profile_input< profiler_test::grammar >( in ) );
+      TEST_ASSERT( profile::entries()[ internal::rule_id< profiler_test::a >::value ].start == starts + 4 );
+      TEST_ASSERT( profile::buffer().reader_calls == 5 );
+      TEST_ASSERT( profile::buffer().read_bytes == 4 );
+      std::ostringstream b;
+      profile::report( b );
+      TEST_ASSERT( b.str().find( "buffer: maximum 4 bytes, 5 reads of 4 of 5 bytes, 0 discards moved 0 bytes\n" ) != std::string::npos );
+      profile::reset();
+      TEST_ASSERT( profile::buffer().reader_calls == 0 );
+
+      // Every thread has its own table.
+
+      std::size_t other = 0;
+      std::thread t( [ & ](){
+            parse_string< profiler_test::grammar, nothing, profiler >( "abba", __FILE__ );
+            other = profile::entries()[ internal::rule_id< profiler_test::a >::value ].start;
+         } );
+      t.join();
+      TEST_ASSERT( other == 4 );
+      TEST_ASSERT( profile::entries()[ internal::rule_id< profiler_test::a >::value ].start == 0 );
+   }
+
+} // pegtl
+
+#include "main.hh"
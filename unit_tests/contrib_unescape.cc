@@ -25,6 +25,25 @@ namespace pegtl
    template<> struct unaction< escaped_x > : unescape::unescape_x {};
    template<> struct unaction< utf8::any > : unescape::append_all {};
 
+   struct jstring : seq< one< '"' >, unescape::json_content, one< '"' >, eof > {};
+
+   template< typename Rule > struct jaction : nothing< Rule > {};
+
+   template<> struct jaction< unescape::json_content > : unescape::unescape_json {};
+
+   struct jfused : seq< one< '"' >, unescape::json_unescaped, one< '"' >, eof > {};
+
+   template< unsigned M, unsigned N >
+   void verify_json( const char ( & m )[ M ], const char ( & n )[ N ] )
+   {
+      unescape::state st;
+      TEST_ASSERT( ( parse_string< jstring, jaction >( std::string( m, M - 1 ), __FUNCTION__, st ) ) );
+      TEST_ASSERT( st.unescaped == std::string( n, N - 1 ) );
+      unescape::state fu;
+      TEST_ASSERT( ( parse_string< jfused >( std::string( m, M - 1 ), __FUNCTION__, fu ) ) );
+      TEST_ASSERT( fu.unescaped == std::string( n, N - 1 ) );
+   }
+
    template< unsigned M, unsigned N >
    void verify_data( const char ( & m )[ M ], const char ( & n )[ N ] )
    {
@@ -55,6 +74,33 @@ namespace pegtl
       verify_data( "\\jd800\\j0020", "\xed\xa0\x80 " );
       verify_data( "\\jd800\\jdc00", "\xf0\x90\x80\x80" );
       verify_data( "\\j0000\\u0000\x00", "\x00\x00\x00" );
+      verify_json( "\"\"", "" );
+      verify_json( "\"abc\"", "abc" );
+      verify_json( "\"abcdefghijklmnopqrstuvwxyz0123456789\"", "abcdefghijklmnopqrstuvwxyz0123456789" );
+      verify_json( "\"abcdefgh\\tijklmnop\\\"\\\\\\/\\b\\f\\n\\r\"", "abcdefgh\tijklmnop\"\\/\b\f\n\r" );
+      verify_json( "\"\\u0020\\u00e4\\u20AC\"", " \xc3\xa4\xe2\x82\xac" );
+      verify_json( "\"\\ud834\\udd1e\\ud834 \"", "\xf0\x9d\x84\x9e\xed\xa0\xb4 " );
+      verify_json( "\"0123456\xc3\xa4\xf4\x8f\xbf\xbf" "0123456789\"", "0123456\xc3\xa4\xf4\x8f\xbf\xbf" "0123456789" );
+      TEST_ASSERT( ! parse_string< jstring >( "\"abc", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"abcdefghijk", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"abc\tdefghijkl\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"abc\\x\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"abc\\u12g4\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"abc\\u12\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"abc\\\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"\xff\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"\xc0\x80\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"\xf4\x90\x80\x80\"", __FUNCTION__ ) );
+      TEST_ASSERT( ! parse_string< jstring >( "\"\xc3\"", __FUNCTION__ ) );
+
+      {
+         unescape::state fu;
+         TEST_ASSERT( ! parse_string< jfused >( "\"ab\\tcd\\u12\"", __FUNCTION__, fu ) );
+         TEST_ASSERT( fu.unescaped.empty() );
+         TEST_ASSERT( ( parse_string< seq< at< jfused >, jfused > >( "\"a\\nb\"", __FUNCTION__, fu ) ) );
+         TEST_ASSERT( fu.unescaped == "a\nb" );
+      }
+
       unescape::state st;
       verify_fail< unstring, unaction >( __LINE__, __FILE__, "\\", st );
       verify_fail< unstring, unaction >( __LINE__, __FILE__, "\\\\\\", st );
@@ -0,0 +1,149 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+#include <random>
+#include <vector>
+
+#include "test.hh"
+
+#include <pegtl/contrib/uri.hh>
+#include <pegtl/contrib/uri_address.hh>
+
+namespace pegtl
+{
+   namespace uri_address_test
+   {
+      // Returns the number of bytes matched by Rule at the beginning of s, or -1;
+      // the input is copied to a buffer of the exact size for sanitizers.
+
+      template< typename Rule >
+      long matched( const std::string & s )
+      {
+         const std::vector< char > v( s.begin(), s.end() );
+         memory_input in( 1, 0, v.data(), v.data() + v.size(), "test" );
+         return parse_input< Rule >( in ) ? long( in.begin() - v.data() ) : -1;
+      }
+
+      template< typename Rule > struct address_action : nothing< Rule > {};
+
+      template<> struct address_action< uri::IPv4binary::value >
+      {
+         static void apply( const uri::ipv4_bytes & a, std::string & s )
+         {
+            s.assign( a.begin(), a.end() );
+         }
+      };
+
+      template<> struct address_action< uri::IPv6binary::value >
+      {
+         static void apply( const uri::ipv6_bytes & a, std::string & s )
+         {
+            s.assign( a.begin(), a.end() );
+         }
+      };
+
+      std::string ipv4( const std::string & s )
+      {
+         uri::ipv4_bytes a;
+         return uri::parse_ipv4( s.data(), s.size(), a ) ? std::string( a.begin(), a.end() ) : "invalid";
+      }
+
+      std::string ipv6( const std::string & s )
+      {
+         uri::ipv6_bytes a;
+         return uri::parse_ipv6( s.data(), s.size(), a ) ? std::string( a.begin(), a.end() ) : "invalid";
+      }
+
+      std::string random_text( std::mt19937 & r, const std::string & alphabet, const std::size_t max )
+      {
+         std::string s;
+         for ( std::size_t n = r() % ( max + 1 ); n; --n ) {
+            s += alphabet[ r() % alphabet.size() ];
+         }
+         return s;
+      }
+
+      std::string random_ipv6( std::mt19937 & r )
+      {
+         static const char * const groups[] = { "0", "1", "ab", "FFFF", "12345", "0db8", "" };
+         std::string s;
+         const unsigned n = r() % 10;
+         const unsigned gap = r() % 10;
+         for ( unsigned i = 0; i < n; ++i ) {
+            s += ( i == gap ) ? "::" : ( i ? ":" : "" );
+            s += groups[ r() % 7 ];
+         }
+         if ( r() % 4 == 0 ) {
+            s += ( r() % 2 ) ? ":" : "::";
+            s += random_text( r, "0123456789.", 16 );
+         }
+         return s + random_text( r, ":]", 2 );
+      }
+
+   } // uri_address_test
+
+   void unit_test()
+   {
+      using namespace uri_address_test;
+
+      TEST_ASSERT( ipv4( "192.168.0.1" ) == std::string( "\xc0\xa8\x00\x01", 4 ) );
+      TEST_ASSERT( ipv4( "255.255.255.255" ) == "\xff\xff\xff\xff" );
+      TEST_ASSERT( ipv4( "0.10.200.9" ) == std::string( "\x00\x0a\xc8\x09", 4 ) );
+      TEST_ASSERT( ipv4( "256.0.0.1" ) == "invalid" );
+      TEST_ASSERT( ipv4( "01.0.0.1" ) == "invalid" );
+      TEST_ASSERT( ipv4( "1.2.3" ) == "invalid" );
+      TEST_ASSERT( ipv4( "1.2.3.4." ) == "invalid" );
+      TEST_ASSERT( ipv4( "" ) == "invalid" );
+
+      TEST_ASSERT( ipv6( "2001:db8::7" ) == std::string( "\x20\x01\x0d\xb8\0\0\0\0\0\0\0\0\0\0\0\x07", 16 ) );
+      TEST_ASSERT( ipv6( "::" ) == std::string( 16, '\0' ) );
+      TEST_ASSERT( ipv6( "::1" ) == std::string( 15, '\0' ) + '\x01' );
+      TEST_ASSERT( ipv6( "1::" ) == '\0' + std::string( "\x01" ) + std::string( 14, '\0' ) );
+      TEST_ASSERT( ipv6( "::ffff:10.0.0.1" ) == std::string( 10, '\0' ) + std::string( "\xff\xff\x0a\x00\x00\x01", 6 ) );
+      TEST_ASSERT( ipv6( "FEDC:BA98:7654:3210:FEDC:BA98:7654:3210" ) == "\xfe\xdc\xba\x98\x76\x54\x32\x10\xfe\xdc\xba\x98\x76\x54\x32\x10" );
+      TEST_ASSERT( ipv6( "1:2:3:4:5:6:7::" ) != "invalid" );
+      TEST_ASSERT( ipv6( "1:2:3:4:5:6:7:8:9" ) == "invalid" );
+      TEST_ASSERT( ipv6( "1:2:3:4:5:6:7" ) == "invalid" );
+      TEST_ASSERT( ipv6( "1::2::3" ) == "invalid" );
+      TEST_ASSERT( ipv6( "12345::" ) == "invalid" );
+      TEST_ASSERT( ipv6( ":1::" ) == "invalid" );
+      TEST_ASSERT( ipv6( "1:2:3:4:5:6::1.2.3.4" ) == "invalid" );
+
+      std::string a;
+      TEST_ASSERT( ( parse_string< seq< one< '[' >, uri::IPv6binary, one< ']' > >, address_action >( "[::ffff:1.2.3.4]", "test", a ) ) );
+      TEST_ASSERT( a == std::string( 10, '\0' ) + std::string( "\xff\xff\x01\x02\x03\x04", 6 ) );
+      TEST_ASSERT( ( parse_string< seq< uri::IPv4binary, eof >, address_action >( "10.1.2.3", "test", a ) ) );
+      TEST_ASSERT( a == "\x0a\x01\x02\x03" );
+
+      // The decoders look at most ipv6_lookahead bytes far.
+
+      std::string longest;
+      for ( unsigned i = 0; i < 7; ++i ) {
+         longest += "ffff:";
+      }
+      longest += "255.255.255.255abcd";
+      TEST_ASSERT( longest.size() == 54 );
+      for ( std::size_t n = 0; n <= longest.size(); ++n ) {
+         for ( const auto & s : { longest.substr( 0, n ), longest.substr( 0, n ) + ']' } ) {
+            TEST_ASSERT( ( matched< seq< uri::IPv6binary, one< ']' > > >( s ) == matched< seq< uri::IPv6address, one< ']' > > >( s ) ) );
+            TEST_ASSERT( matched< uri::IPv4binary >( s.substr( 35 < n ? 35 : n ) ) == matched< uri::IPv4address >( s.substr( 35 < n ? 35 : n ) ) );
+         }
+      }
+
+      // The binary rules match the same as the textual rules.
+
+      std::mt19937 r;
+      for ( unsigned i = 0; i < 200000; ++i ) {
+         const std::string s = random_text( r, "0123456789.", 20 );
+         TEST_ASSERT( matched< uri::IPv4binary >( s ) == matched< uri::IPv4address >( s ) );
+      }
+      for ( unsigned i = 0; i < 200000; ++i ) {
+         const std::string s = random_ipv6( r );
+         TEST_ASSERT( ( matched< seq< uri::IPv6binary, one< ']' > > >( s ) == matched< seq< uri::IPv6address, one< ']' > > >( s ) ) );
+      }
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,59 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include <string>
+
+#include "test.hh"
+
+#include <pegtl/contrib/uri_parser.hh>
+
+namespace pegtl
+{
+   namespace uri_parser_test
+   {
+      std::string show( const view & v )
+      {
+         return v.data ? ( '[' + v.string() + ']' ) : "-";
+      }
+
+      template< typename Rule = uri::URI_reference >
+      std::string split( const std::string & in )
+      {
+         uri::parse_result r;
+         if ( ! uri::parse_components< Rule >( in.data(), in.size(), r ) ) {
+            return "invalid";
+         }
+         return show( r.scheme ) + show( r.userinfo ) + show( r.host ) + show( r.port ) + show( r.path ) + show( r.query ) + show( r.fragment );
+      }
+
+   } // uri_parser_test
+
+   void unit_test()
+   {
+      using namespace uri_parser_test;
+
+      TEST_ASSERT( split( "http://user:pw@www.example.com:8080/a/b.html?x=1&y=2#top" ) == "[http][user:pw][www.example.com][8080][/a/b.html][x=1&y=2][top]" );
+      TEST_ASSERT( split( "https://example.org" ) == "[https]-[example.org]-[]--" );
+      TEST_ASSERT( split( "http://a/?" ) == "[http]-[a]-[/][]-" );
+      TEST_ASSERT( split( "http://a:/" ) == "[http]-[a][][/]--" );
+      TEST_ASSERT( split( "ldap://[2001:db8::7]/c=GB?objectClass?one" ) == "[ldap]-[[2001:db8::7]]-[/c=GB][objectClass?one]-" );
+      TEST_ASSERT( split( "ftp://192.168.1.17:21" ) == "[ftp]-[192.168.1.17][21][]--" );
+      TEST_ASSERT( split( "mailto:someone@example.com" ) == "[mailto]---[someone@example.com]--" );
+      TEST_ASSERT( split( "urn:isbn:0451450523" ) == "[urn]---[isbn:0451450523]--" );
+      TEST_ASSERT( split( "file:///etc/fstab" ) == "[file]-[]-[/etc/fstab]--" );
+
+      TEST_ASSERT( split( "a/b:c" ) == "----[a/b:c]--" );
+      TEST_ASSERT( split( "//example.net/x" ) == "--[example.net]-[/x]--" );
+      TEST_ASSERT( split( "../x?y#z" ) == "----[../x][y][z]" );
+      TEST_ASSERT( split( "#z" ) == "----[]-[z]" );
+      TEST_ASSERT( split( "" ) == "----[]--" );
+
+      TEST_ASSERT( split( "http://a b" ) == "invalid" );
+      TEST_ASSERT( split( "http://[::1" ) == "invalid" );
+      TEST_ASSERT( split< uri::URI >( "a/b" ) == "invalid" );
+      TEST_ASSERT( split< uri::absolute_URI >( "http://a/#x" ) == "invalid" );
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -0,0 +1,83 @@
+// Copyright (c) 2016 Dr. Colin Hirsch and Daniel Frey
+// Please see LICENSE for license or visit https://github.com/ColinH/PEGTL/
+
+#include "test.hh"
+
+#include <pegtl/contrib/json.hh>
+
+namespace pegtl
+{
+   namespace static_analysis_test
+   {
+      using analysis::byte_set;
+      using analysis::first_set;
+
+      struct keyword : sor< string< 'i', 'n', 't' >, istring< 'f', 'o', 'r' > > {};
+      struct number : seq< opt< one< '-' > >, plus< digit > > {};
+      struct value;
+      struct array : seq< one< '[' >, opt< list< value, one< ',' > > >, one< ']' > > {};
+      struct value : sor< number, array > {};
+      struct guarded : seq< not_at< one< 'x' > >, at< alpha >, opt< blank >, alpha > {};
+      struct wide : utf8::range< 0x80, 0x7ff > {};
+      struct grammar : seq< star< sor< keyword, value, guarded, wide > >, eof > {};
+
+      struct left : sor< seq< left, one< '+' > >, digit > {};
+      struct empty : star< opt< digit > > {};
+
+      static_assert( ! analysis::has_cycles< grammar >::value, "grammar has cycles" );
+      static_assert( ! analysis::has_cycles< json::text >::value, "json grammar has cycles" );
+      static_assert( analysis::has_cycles< left >::value, "left recursion not detected" );
+      static_assert( analysis::has_cycles< empty >::value, "nullable loop body not detected" );
+
+      static_assert( ! analysis::is_nullable< value >::value, "value is nullable" );
+      static_assert( analysis::is_nullable< grammar >::value, "grammar is not nullable" );
+      static_assert( analysis::is_nullable< guarded >::value == false, "guarded is nullable" );
+
+      static_assert( first_set< keyword >::value == ( analysis::byte_bit( 'i' ) | analysis::byte_bit( 'f' ) | analysis::byte_bit( 'F' ) ), "first set of keyword" );
+      static_assert( first_set< number >::value.count() == 11, "first set of number" );
+      static_assert( first_set< value >::value.count() == 12, "first set of value" );
+      static_assert( first_set< guarded >::value == ( first_set< blank >::value | first_set< alpha >::value ), "first set of guarded" );
+      static_assert( first_set< wide >::value == analysis::byte_range( 0xc2, 0xdf ), "first set of wide" );
+      static_assert( first_set< left >::value.count() == 10, "first set of left" );
+      static_assert( first_set< utf16::any >::value.count() == 256, "first set of utf16::any" );
+      static_assert( ! first_set< eof >::value.any(), "first set of eof" );
+
+      static_assert( analysis::char_range( 'a', 'z' ).count() == 26, "char_range" );
+      static_assert( analysis::char_range( 'z', 'a' ).count() == 0, "empty char_range" );
+      static_assert( analysis::utf8_range( 0, 0x10ffff ).count() == 128 + 30 + 16 + 5, "utf8_range" );
+
+      // The compile-time first sets are supersets of those of analyze_grammar.
+
+      template< typename Rule >
+      bool matches_runtime( const analysis::analyze_grammar< grammar > & a, const bool exact )
+      {
+         const auto s = first_set< Rule >::value.bits();
+         const auto r = a.get< Rule >().first;
+         return exact ? ( s == r ) : ( ( s & r ) == r );
+      }
+
+   } // static_analysis_test
+
+   void unit_test()
+   {
+      using namespace static_analysis_test;
+
+      const analysis::analyze_grammar< grammar > a;
+
+      TEST_ASSERT( matches_runtime< keyword >( a, true ) );
+      TEST_ASSERT( matches_runtime< number >( a, true ) );
+      TEST_ASSERT( matches_runtime< value >( a, true ) );
+      TEST_ASSERT( matches_runtime< array >( a, true ) );
+      TEST_ASSERT( matches_runtime< wide >( a, true ) );
+      TEST_ASSERT( matches_runtime< guarded >( a, false ) );
+      TEST_ASSERT( matches_runtime< grammar >( a, false ) );
+
+      const analysis::analyze_grammar< json::text > j;
+
+      TEST_ASSERT( first_set< json::value >::value.bits() == j.get< json::value >().first );
+      TEST_ASSERT( first_set< json::text >::value.bits() == j.get< json::text >().first );
+   }
+
+} // pegtl
+
+#include "main.hh"
@@ -24,6 +24,13 @@ namespace pegtl
       if ( does_consume != expect_consume ) {
          TEST_FAILED( "analyze -- consumes received/expected [ " << does_consume << " / " << expect_consume << " ]" );
       }
+      if ( analysis::has_cycles< Rule >::value != expect_problems ) {
+         TEST_FAILED( "analyze -- static problems received/expected [ " << analysis::has_cycles< Rule >::value << " / " << expect_problems << " ]" );
+      }
+      // With cycles the runtime result for consumption depends on where the search starts.
+      if ( ( ! expect_problems ) && ( analysis::is_nullable< Rule >::value == expect_consume ) ) {
+         TEST_FAILED( "analyze -- static consumes received/expected [ " << ! analysis::is_nullable< Rule >::value << " / " << expect_consume << " ]" );
+      }
    }
 
 } // pegtl